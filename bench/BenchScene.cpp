@@ -0,0 +1,126 @@
+#include "BenchScene.hpp"
+
+#include <Device.hpp>
+#include <SwapChain.hpp>
+#include <default/DefaultRenderPass.hpp>
+
+#include <cmath>
+
+const std::vector<SceneKind> BenchScene::Kinds = {SceneKind::Triangles, SceneKind::Draws, SceneKind::Instances, SceneKind::Pipelines};
+
+BenchScene::BenchScene(SceneKind kind, uint32_t count, const Device &device, const DefaultRenderPass &renderPass, const SwapChain &swapChain)
+{
+    std::vector<ShaderInfo> shaders = {ShaderInfo("base", true), ShaderInfo("base", false)};
+    _pipelines.push_back(std::make_unique<GraphicsPipeline>(device, swapChain, renderPass, shaders));
+
+    uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+
+    switch (kind)
+    {
+    case SceneKind::Triangles:
+    {
+        MeshBuilder builder;
+        for (uint32_t cell = 0; cell < count; cell++)
+            AddCellTriangle(builder, cell, side);
+
+        // Generated in a cache friendly order already, and optimizing millions of triangles would take longer than the run
+        _renderers.push_back(std::make_unique<BaseRenderer>(device, renderPass, swapChain, *_pipelines[0], builder.build(false)));
+        break;
+    }
+    case SceneKind::Draws:
+    case SceneKind::Pipelines:
+    {
+        // Pipeline 0 is shared by the draws, the others are identical but distinct objects, bound one after the other
+        if (kind == SceneKind::Pipelines)
+            for (uint32_t i = 1; i < count; i++)
+                _pipelines.push_back(std::make_unique<GraphicsPipeline>(device, swapChain, renderPass, shaders));
+
+        for (uint32_t cell = 0; cell < count; cell++)
+        {
+            MeshBuilder builder;
+            AddCellTriangle(builder, cell, side);
+
+            const GraphicsPipeline &pipeline = *_pipelines[kind == SceneKind::Pipelines ? cell : 0];
+            _renderers.push_back(std::make_unique<BaseRenderer>(device, renderPass, swapChain, pipeline, builder.build(false)));
+        }
+        break;
+    }
+    case SceneKind::Instances:
+    {
+        // The base shader has no per-instance data : every instance lands on the same spot. Sized like a cell of the
+        // triangles scene, so that both shade about as many fragments and this one doesn't end up measuring fill rate
+        MeshBuilder builder;
+        AddCellTriangle(builder, 0, side);
+
+        _renderers.push_back(std::make_unique<BaseRenderer>(device, renderPass, swapChain, *_pipelines[0], builder.build(false)));
+        _renderers.back()->instanceCount = count;
+        break;
+    }
+    }
+}
+
+void BenchScene::AddCellTriangle(MeshBuilder &builder, uint32_t cell, uint32_t side)
+{
+    float size = 2.0f / static_cast<float>(side);
+    float x = -1.0f + static_cast<float>(cell % side) * size;
+    float y = -1.0f + static_cast<float>(cell / side) * size;
+
+    // A gradient over the grid, to tell the cells apart on a readback
+    glm::vec3 color = {static_cast<float>(cell % side) / side, static_cast<float>(cell / side) / side, 1.0f};
+
+    builder.addTriangle({{x + size * 0.5f, y + size * 0.1f, 0.0f}, color},
+                        {{x + size * 0.9f, y + size * 0.9f, 0.0f}, color},
+                        {{x + size * 0.1f, y + size * 0.9f, 0.0f}, color});
+}
+
+std::vector<Renderer *> BenchScene::drawList() const
+{
+    std::vector<Renderer *> drawList;
+    drawList.reserve(_renderers.size());
+    for (const auto &renderer : _renderers)
+        drawList.push_back(renderer.get());
+    return drawList;
+}
+
+const char *BenchScene::KindName(SceneKind kind)
+{
+    switch (kind)
+    {
+    case SceneKind::Triangles:
+        return "triangles";
+    case SceneKind::Draws:
+        return "draws";
+    case SceneKind::Instances:
+        return "instances";
+    case SceneKind::Pipelines:
+        return "pipelines";
+    }
+    return "unknown";
+}
+
+uint32_t BenchScene::DefaultCount(SceneKind kind)
+{
+    switch (kind)
+    {
+    case SceneKind::Triangles:
+        return 1'000'000;
+    case SceneKind::Draws:
+        return 10'000;
+    case SceneKind::Instances:
+        return 100'000;
+    case SceneKind::Pipelines:
+        return 256;
+    }
+    return 1;
+}
+
+bool BenchScene::ParseKind(const std::string &name, SceneKind &kind)
+{
+    for (SceneKind candidate : Kinds)
+        if (name == KindName(candidate))
+        {
+            kind = candidate;
+            return true;
+        }
+    return false;
+}
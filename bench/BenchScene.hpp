@@ -0,0 +1,57 @@
+#pragma once
+#include "global.hpp"
+
+#include <GraphicsPipeline.hpp>
+#include <default/BaseRenderer.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Forward declaration
+class Device;
+class DefaultRenderPass;
+class SwapChain;
+
+/// @brief What a scene scales with its count
+enum class SceneKind
+{
+    /// @brief One draw of `count` triangles : vertex throughput
+    Triangles,
+    /// @brief `count` draws of one triangle each : recording and submission overhead
+    Draws,
+    /// @brief One cell-sized triangle drawn `count` times by a single instanced draw : per-instance overhead
+    Instances,
+    /// @brief `count` draws, each with its own pipeline : pipeline binds
+    Pipelines
+};
+
+/// @brief Synthetic scene scaling one kind of load, everything else kept to the minimum.
+/// Triangles are spread over a grid covering the screen, so that they neither overlap nor get culled
+class BenchScene
+{
+private:
+    std::vector<std::unique_ptr<GraphicsPipeline>> _pipelines;
+    std::vector<std::unique_ptr<BaseRenderer>> _renderers;
+
+    /// @brief Triangle in cell `cell` of a `side` x `side` grid over clip space
+    static void AddCellTriangle(MeshBuilder &builder, uint32_t cell, uint32_t side);
+
+public:
+    /// @brief Every kind, in the order the benchmark runs them by default
+    static const std::vector<SceneKind> Kinds;
+
+    BenchScene(SceneKind kind, uint32_t count, const Device &device, const DefaultRenderPass &renderPass, const SwapChain &swapChain);
+
+    BenchScene(const BenchScene &) = delete;
+    BenchScene &operator=(const BenchScene &) = delete;
+
+    /// @brief Renderers to hand to the application, in draw order
+    std::vector<Renderer *> drawList() const;
+
+    static const char *KindName(SceneKind kind);
+    /// @brief Default count of a kind, sized for a few milliseconds per frame on a desktop GPU
+    static uint32_t DefaultCount(SceneKind kind);
+    /// @return False if `name` isn't the name of a kind
+    static bool ParseKind(const std::string &name, SceneKind &kind);
+};
@@ -0,0 +1,116 @@
+#include "global.hpp"
+#include <JobSystem.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+// Scheduling overhead of the job system : every job is (almost) empty, so the time per job is what the scheduler costs
+
+using Clock = std::chrono::steady_clock;
+
+static double NanosecondsPer(Clock::duration duration, size_t count)
+{
+    return std::chrono::duration<double, std::nano>(duration).count() / static_cast<double>(count);
+}
+
+/// @brief Jobs queued from the main thread, all waited on with one counter
+static double SpawnAndWait(JobSystem &jobs, size_t jobCount)
+{
+    std::atomic<uint64_t> sink{0};
+    JobCounter counter;
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < jobCount; i++)
+        jobs.run([&sink]
+                 { sink.fetch_add(1, std::memory_order_relaxed); },
+                 &counter);
+    jobs.wait(counter);
+
+    return NanosecondsPer(Clock::now() - start, jobCount);
+}
+
+/// @brief Jobs spawning jobs : the children land on the workers' own deques, as culling or recording would do
+static double NestedSpawn(JobSystem &jobs, size_t parents, size_t children)
+{
+    std::atomic<uint64_t> sink{0};
+    JobCounter counter;
+
+    auto start = Clock::now();
+    for (size_t p = 0; p < parents; p++)
+        jobs.run([&jobs, &sink, &counter, children]
+                 {
+                     for (size_t c = 0; c < children; c++)
+                         jobs.run([&sink]
+                                  { sink.fetch_add(1, std::memory_order_relaxed); },
+                                  &counter); },
+                 &counter);
+    jobs.wait(counter);
+
+    return NanosecondsPer(Clock::now() - start, parents * (children + 1));
+}
+
+/// @brief parallelFor over a large range, one slice per job
+static double ParallelFor(JobSystem &jobs, size_t items, size_t grain)
+{
+    std::vector<uint32_t> data(items, 1);
+
+    auto start = Clock::now();
+    jobs.parallelFor(items, grain, [&data](size_t first, size_t last)
+                     {
+                         for (size_t i = first; i < last; i++)
+                             data[i] *= 3; });
+
+    return NanosecondsPer(Clock::now() - start, (items + grain - 1) / grain);
+}
+
+/// @brief Same lambdas called inline, the floor any scheduler is compared to
+static double Inline(size_t jobCount)
+{
+    std::atomic<uint64_t> sink{0};
+    std::vector<JobSystem::Job> inlineJobs(jobCount, [&sink]
+                                           { sink.fetch_add(1, std::memory_order_relaxed); });
+
+    auto start = Clock::now();
+    for (JobSystem::Job &job : inlineJobs)
+        job();
+
+    return NanosecondsPer(Clock::now() - start, jobCount);
+}
+
+int main()
+{
+    const size_t JobCount = 1'000'000;
+    const size_t Repeats = 5;
+
+    uint32_t maxWorkers = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+
+    std::printf("inline call                       : %8.1f ns/job\n", Inline(JobCount));
+    std::printf("%-8s %16s %16s %16s\n", "threads", "spawn+wait", "nested spawn", "parallelFor");
+
+    // 1 (no worker : the main thread runs everything), 2, 4... threads, then every core
+    std::vector<uint32_t> workerCounts = {0};
+    for (uint32_t threads = 2; threads - 1 < maxWorkers; threads *= 2)
+        workerCounts.push_back(threads - 1);
+    if (maxWorkers > 0)
+        workerCounts.push_back(maxWorkers);
+
+    for (uint32_t workers : workerCounts)
+    {
+        JobSystem jobs(workers);
+
+        // Best of a few runs : the first one also pays for the deques growing
+        double spawn = 1e30, nested = 1e30, loop = 1e30;
+        for (size_t r = 0; r < Repeats; r++)
+        {
+            spawn = std::min(spawn, SpawnAndWait(jobs, JobCount));
+            nested = std::min(nested, NestedSpawn(jobs, JobCount / 1000, 999));
+            loop = std::min(loop, ParallelFor(jobs, JobCount * 16, 1024));
+        }
+
+        std::printf("%-8u %13.1f ns %13.1f ns %13.1f ns\n", jobs.threadCount(), spawn, nested, loop);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,348 @@
+#include "global.hpp"
+#include <Application.hpp>
+
+#include "BenchScene.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Frame timings of the whole renderer over generated scenes : each scene runs in its own (headless by default) application,
+// for a fixed number of frames after a warmup, and every timing of FrameTimings ends up summarized in a JSON report
+
+struct Summary
+{
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    size_t samples = 0;
+};
+
+/// @brief Pipeline statistics of a pass, as means per frame
+struct PassReport
+{
+    std::string name;
+    double inputVertices = 0.0;
+    double vertexInvocations = 0.0;
+    double clippingInvocations = 0.0;
+    double clippingPrimitives = 0.0;
+    double fragmentInvocations = 0.0;
+    size_t samples = 0;
+};
+
+struct SceneReport
+{
+    SceneKind kind;
+    uint32_t count;
+    Summary cpu, record, submit, gpu;
+    /// @brief GPU time of each profiler scope below the frame, by name, in the order the frames record them
+    std::vector<std::pair<std::string, Summary>> gpuScopes;
+    /// @brief Empty unless run with --statistics
+    std::vector<PassReport> passes;
+};
+
+/// @brief Nearest-rank percentiles, negative samples (unknown GPU times) left out
+static Summary Summarize(std::vector<double> samples)
+{
+    samples.erase(std::remove_if(samples.begin(), samples.end(), [](double sample)
+                                 { return sample < 0.0; }),
+                  samples.end());
+
+    Summary summary;
+    summary.samples = samples.size();
+    if (samples.empty())
+        return summary;
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p)
+    {
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * static_cast<double>(samples.size())));
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+
+    for (double sample : samples)
+        summary.mean += sample;
+    summary.mean /= static_cast<double>(samples.size());
+    summary.p50 = percentile(50.0);
+    summary.p95 = percentile(95.0);
+    summary.p99 = percentile(99.0);
+    return summary;
+}
+
+static SceneReport RunScene(SceneKind kind, uint32_t count, uint64_t warmup, uint64_t frames, bool windowed, bool statistics,
+                            std::string &deviceName)
+{
+    HeadlessSettings headless;
+    headless.enabled = !windowed;
+    headless.frameCount = warmup + frames;
+
+    Application app(false, DEFAULT_FRAMES_IN_FLIGHT, headless);
+    app.enablePipelineStatistics(statistics);
+
+    // Declared after the application : destroyed first, while the device is still there
+    std::unique_ptr<BenchScene> scene;
+    app.buildScene([&](const Device &device, const DefaultRenderPass &renderPass, const SwapChain &swapChain)
+                   {
+                       VkPhysicalDeviceProperties properties;
+                       vkGetPhysicalDeviceProperties(device.physical(), &properties);
+                       deviceName = properties.deviceName;
+
+                       scene = std::make_unique<BenchScene>(kind, count, device, renderPass, swapChain);
+                       return scene->drawList(); });
+    app.run();
+
+    // Warmup frames fill the caches and the pools, they are not what is measured
+    std::vector<double> cpu, record, submit, gpu;
+    std::vector<std::pair<std::string, std::vector<double>>> gpuScopes;
+    std::vector<PassReport> passes;
+    for (const FrameTimings &timings : app.frameTimings())
+    {
+        if (timings.frameNumber < warmup)
+            continue;
+        cpu.push_back(timings.cpuMs);
+        record.push_back(timings.recordMs);
+        submit.push_back(timings.submitMs);
+        gpu.push_back(timings.gpuMs);
+
+        // The frame itself is gpuMs already
+        for (size_t i = 1; i < timings.gpuScopes.size(); i++)
+        {
+            const GpuScopeResult &scope = timings.gpuScopes[i];
+            auto samples = std::find_if(gpuScopes.begin(), gpuScopes.end(), [&scope](const auto &entry)
+                                        { return entry.first == scope.name; });
+            if (samples == gpuScopes.end())
+                samples = gpuScopes.insert(gpuScopes.end(), {scope.name, {}});
+            samples->second.push_back(scope.ms);
+        }
+
+        for (const PassStatistics &statistics : timings.passStatistics)
+        {
+            auto pass = std::find_if(passes.begin(), passes.end(), [&statistics](const PassReport &pass)
+                                     { return pass.name == statistics.name; });
+            if (pass == passes.end())
+            {
+                pass = passes.insert(passes.end(), PassReport{});
+                pass->name = statistics.name;
+            }
+
+            pass->inputVertices += static_cast<double>(statistics.inputVertices);
+            pass->vertexInvocations += static_cast<double>(statistics.vertexInvocations);
+            pass->clippingInvocations += static_cast<double>(statistics.clippingInvocations);
+            pass->clippingPrimitives += static_cast<double>(statistics.clippingPrimitives);
+            pass->fragmentInvocations += static_cast<double>(statistics.fragmentInvocations);
+            pass->samples++;
+        }
+    }
+
+    // Totals to means
+    for (PassReport &pass : passes)
+    {
+        double samples = static_cast<double>(pass.samples);
+        pass.inputVertices /= samples;
+        pass.vertexInvocations /= samples;
+        pass.clippingInvocations /= samples;
+        pass.clippingPrimitives /= samples;
+        pass.fragmentInvocations /= samples;
+    }
+
+    SceneReport report{kind, count, Summarize(cpu), Summarize(record), Summarize(submit), Summarize(gpu), {}, std::move(passes)};
+    for (auto &[name, samples] : gpuScopes)
+        report.gpuScopes.emplace_back(name, Summarize(std::move(samples)));
+    return report;
+}
+
+static void WriteStatistics(std::ostream &out, const Summary &summary)
+{
+    // No timestamps on this queue
+    if (summary.samples == 0)
+        out << "null";
+    else
+        out << "{\"mean\": " << summary.mean << ", \"p50\": " << summary.p50 << ", \"p95\": " << summary.p95 << ", \"p99\": " << summary.p99 << "}";
+}
+
+static void WriteSummary(std::ostream &out, const char *name, const Summary &summary, bool last)
+{
+    out << "      \"" << name << "\": ";
+    WriteStatistics(out, summary);
+    out << (last ? "\n" : ",\n");
+}
+
+/// @brief {"Scene": {...}, "UI": {...}}, null without timestamps
+static void WriteScopes(std::ostream &out, const std::vector<std::pair<std::string, Summary>> &scopes)
+{
+    out << "      \"gpuScopesMs\": ";
+    if (scopes.empty())
+    {
+        out << "null,\n";
+        return;
+    }
+
+    out << "{\n";
+    for (size_t i = 0; i < scopes.size(); i++)
+    {
+        out << "        \"" << scopes[i].first << "\": ";
+        WriteStatistics(out, scopes[i].second);
+        out << (i + 1 < scopes.size() ? ",\n" : "\n");
+    }
+    out << "      },\n";
+}
+
+/// @brief {"Scene": {"inputVertices": ...}, "UI": {...}}, null without --statistics or pipelineStatisticsQuery
+static void WritePasses(std::ostream &out, const std::vector<PassReport> &passes)
+{
+    out << "      \"pipelineStatistics\": ";
+    if (passes.empty())
+    {
+        out << "null\n";
+        return;
+    }
+
+    out << "{\n";
+    for (size_t i = 0; i < passes.size(); i++)
+    {
+        const PassReport &pass = passes[i];
+        out << "        \"" << pass.name << "\": {\"inputVertices\": " << pass.inputVertices
+            << ", \"vertexInvocations\": " << pass.vertexInvocations
+            << ", \"clippingInvocations\": " << pass.clippingInvocations
+            << ", \"clippingPrimitives\": " << pass.clippingPrimitives
+            << ", \"fragmentInvocations\": " << pass.fragmentInvocations << "}"
+            << (i + 1 < passes.size() ? ",\n" : "\n");
+    }
+    out << "      }\n";
+}
+
+static void WriteReport(std::ostream &out, const std::string &deviceName, uint64_t warmup, uint64_t frames, bool windowed,
+                        const std::vector<SceneReport> &reports)
+{
+    out << "{\n"
+        << "  \"device\": \"" << deviceName << "\",\n"
+        << "  \"headless\": " << (windowed ? "false" : "true") << ",\n"
+        << "  \"warmupFrames\": " << warmup << ",\n"
+        << "  \"frames\": " << frames << ",\n"
+        << "  \"scenes\": [\n";
+
+    for (size_t i = 0; i < reports.size(); i++)
+    {
+        const SceneReport &report = reports[i];
+        out << "    {\n"
+            << "      \"scene\": \"" << BenchScene::KindName(report.kind) << "\",\n"
+            << "      \"count\": " << report.count << ",\n"
+            << "      \"samples\": " << report.cpu.samples << ",\n";
+        WriteSummary(out, "cpuMs", report.cpu, false);
+        WriteSummary(out, "recordMs", report.record, false);
+        WriteSummary(out, "submitMs", report.submit, false);
+        WriteSummary(out, "gpuMs", report.gpu, false);
+        WriteScopes(out, report.gpuScopes);
+        WritePasses(out, report.passes);
+        out << "    }" << (i + 1 < reports.size() ? ",\n" : "\n");
+    }
+
+    out << "  ]\n"
+        << "}\n";
+}
+
+static void PrintUsage(const char *program)
+{
+    std::cerr << "Usage : " << program << " [--scene triangles|draws|instances|pipelines|all] [--count N] [--frames N] [--warmup N]"
+              << " [--output report.json] [--windowed] [--statistics]\n";
+}
+
+int main(int argc, char **argv)
+{
+    std::string sceneName = "all";
+    uint32_t count = 0;
+    uint64_t frames = 500;
+    uint64_t warmup = 50;
+    std::string outputPath = "vkbullshit_bench.json";
+    bool windowed = false;
+    // Off by default : cached command buffers are recorded again every frame while counting, which shows in the CPU times
+    bool statistics = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+            sceneName = argv[++i];
+        else if (strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            count = static_cast<uint32_t>(std::stoul(argv[++i]));
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frames = std::stoull(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+            warmup = std::stoull(argv[++i]);
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (strcmp(argv[i], "--windowed") == 0)
+            windowed = true;
+        else if (strcmp(argv[i], "--statistics") == 0)
+            statistics = true;
+        else
+        {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (frames == 0)
+    {
+        PrintUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<SceneKind> kinds = BenchScene::Kinds;
+    if (sceneName != "all")
+    {
+        SceneKind kind;
+        if (!BenchScene::ParseKind(sceneName, kind))
+        {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        kinds = {kind};
+    }
+
+    if (windowed)
+    {
+        glfwInit();
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    }
+
+    std::string deviceName;
+    std::vector<SceneReport> reports;
+
+    try
+    {
+        for (SceneKind kind : kinds)
+        {
+            uint32_t sceneCount = count != 0 ? count : BenchScene::DefaultCount(kind);
+            reports.push_back(RunScene(kind, sceneCount, warmup, frames, windowed, statistics, deviceName));
+
+            const SceneReport &report = reports.back();
+            std::printf("%-10s x%-9u cpu %7.3f ms  record %7.3f ms  submit %7.3f ms  gpu %7.3f ms (p99 %7.3f / %7.3f)\n",
+                        BenchScene::KindName(kind), sceneCount, report.cpu.mean, report.record.mean, report.submit.mean,
+                        report.gpu.mean, report.cpu.p99, report.gpu.p99);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if (windowed)
+        glfwTerminate();
+
+    std::ofstream output(outputPath);
+    if (!output)
+    {
+        std::cerr << "failed to open " << outputPath << '\n';
+        return EXIT_FAILURE;
+    }
+    WriteReport(output, deviceName, warmup, frames, windowed, reports);
+    std::cout << "Report written to " << outputPath << '\n';
+
+    return EXIT_SUCCESS;
+}
@@ -7,17 +7,65 @@
 #include <SwapChain.hpp>
 #include <GraphicsPipeline.hpp>
 #include <Sync.hpp>
+#include <FrameContext.hpp>
+#include <ParallelRecorder.hpp>
+#include <JobSystem.hpp>
+#include <RenderPacket.hpp>
+#include <TripleBuffer.hpp>
+#include <FrameLimiter.hpp>
+#include <PresentPacer.hpp>
+#include <Readback.hpp>
+#include <FrameTimings.hpp>
+#include <GpuProfiler.hpp>
+#include <PipelineStatistics.hpp>
+#include <CpuProfiler.hpp>
 
 #include <default/DefaultRenderPass.hpp>
 #include <default/BaseRenderer.hpp>
 
 #include <geometry/Vertex.hpp>
+#include <memory/Uploader.hpp>
 
 #include <ui/UI.hpp>
 
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+/// @brief Double buffering : the CPU records a frame while the GPU draws the previous one
+const uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+
+/// @brief Running without a display (build machines, software drivers such as lavapipe) : the frames go to a
+/// VK_EXT_headless_surface swapchain, through the exact same passes, pipelines and UI
+struct HeadlessSettings
+{
+    bool enabled = false;
+    /// @brief Frames to draw before closing, 0 to run until killed
+    uint64_t frameCount = 0;
+    /// @brief Where to write the last frame as a PPM image, nowhere if empty. Needs a frame count
+    std::string readbackPath;
+};
+
+/// @brief Chrome traces of the CPU zones (see CpuProfiler), written on F12 or from the UI, and at exit if asked for
+struct TraceSettings
+{
+    std::string path = "vkbullshit_trace.json";
+    /// @brief Frames covered, the last ones
+    uint32_t frames = 120;
+    bool atExit = false;
+};
+
 class Application
 {
 private:
+    /// @brief First member : everything else may hand it jobs, so it is built before and torn down after them
+    JobSystem jobs;
+
+    HeadlessSettings headless;
+    TraceSettings trace;
     Window window;
     Messenger debugMessenger;
     Device device;
@@ -27,19 +75,104 @@ private:
     BaseRenderer renderer;
     Sync sync;
 
+    /// @brief GPU time of the frame and its passes, shown by the UI
+    GpuProfiler gpuProfiler;
+    /// @brief Vertex and fragment counts of each pass, when turned on through the UI
+    PipelineStatistics pipelineStatistics;
     UI interface;
 
+    /// @brief Draw list of the scene subpass, recorded across threads once large enough
+    std::vector<Renderer *> scene;
+    ParallelRecorder recorder;
+    /// @brief Secondary buffers executed by a subpass, kept to reuse the allocation
+    std::vector<VkCommandBuffer> subpassCommands;
+
+    /// @brief Main thread -> render thread, one frame ahead
+    TripleBuffer<RenderPacket> packets;
+    std::thread renderThread;
+    /// @brief Set with `renderError` when the render thread dies, rethrown by the main thread
+    std::atomic<bool> renderFailed = false;
+    std::exception_ptr renderError;
+    /// @brief Framebuffer resizes reported by the window, and the last count handled by the render thread
+    uint64_t resizeCount = 0;
+    uint64_t handledResizes = 0;
+    /// @brief The swapchain couldn't be recreated (window minimized) and has to be before drawing again
+    bool swapChainOutdated = false;
+
+    /// @brief Main thread FPS cap : the render thread follows, as it only draws what the main thread publishes
+    FrameLimiter frameLimiter;
+    /// @brief Render thread latency limiter
+    PresentPacer presentPacer;
+
+    /// @brief Headless only, copies the last frame back to be saved
+    std::unique_ptr<Readback> readback;
+    /// @brief Render thread : the headless frame count was reached, the main thread can close the window
+    std::atomic<bool> headlessDone = false;
+    /// @brief One per drawn frame, indexed by frame number. Only kept with a frame count, so that it stays bounded
+    std::vector<FrameTimings> timings;
+
+    /// @brief One context per frame in flight, used round-robin
+    std::vector<std::unique_ptr<FrameContext>> frames;
+    uint32_t framesInFlight = 0;
+    /// @brief Size of each frame's ring, see setFrameRingCapacity()
+    VkDeviceSize frameRingCapacity = FrameRing::DefaultCapacity;
+
     size_t currentFrame = 0;
+    /// @brief Frames started since launch, never wraps around
+    uint64_t frameNumber = 0;
+    /// @brief Packets built by the main thread since launch
+    uint64_t packetNumber = 0;
 
     void mainLoop();
 
-    void drawFrame(bool &resized);
+    /// @brief Main thread : polls input, builds the UI and publishes the packet of the next frame
+    void update(bool &resized);
+
+    /// @brief Render thread : draws every packet it gets, until the packets are closed
+    void renderLoop();
+    void stopRenderThread();
+
+    void drawFrame(RenderPacket &packet);
+    /// @brief Records the whole frame in one pass over the swapchain image : scene, then UI on top
+    void recordFrame(VkCommandBuffer commandBuffer, FrameContext &frame, uint32_t imageIndex, RenderPacket &packet);
+    /// @brief Appends to `subpassCommands` a one-off secondary buffer opening GPU scope `name` in `subpass`, or closing the
+    /// innermost one if `name` is null : a pass executing secondary buffers can't record anything else, timestamps included
+    void pushGpuScope(FrameContext &frame, uint32_t subpass, uint32_t imageIndex, const char *name);
+    /// @brief Reads back the GPU times and the pipeline statistics there are, without waiting, into the frame timings
+    void collectQueryResults();
+    /// @brief Whether the frame being drawn has to be read back : the last one of a headless run
+    inline bool readsBack() const { return readback && frameNumber + 1 == headless.frameCount; }
+
+    /// @brief Writes the trace of the last frames, as set by setTrace()
+    void writeTrace();
 
-    void recreateSwapChain(bool &resized);
+    /// @brief Render thread : rebuilds the swapchain and what depends on it, unless the window is minimized
+    void recreateSwapChain();
+
+    /// @brief Changes the number of frames in flight, clamped to [1, FrameContext::MaxFramesInFlight].
+    /// Only waits for the frames already submitted, not for the whole device
+    void setFramesInFlight(uint32_t count);
 
 public:
-    Application(bool enableValidationLayers);
+    /// @brief Builds the renderers of a scene against the application's device, render pass and swapchain
+    using SceneBuilder = std::function<std::vector<Renderer *>(const Device &, const DefaultRenderPass &, const SwapChain &)>;
+
+    Application(bool enableValidationLayers, uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT, const HeadlessSettings &headless = {});
     ~Application();
 
     void run();
+
+    /// @brief Replaces the scene drawn by the one `builder` returns, before run(). The renderers stay owned by the caller,
+    /// and must outlive run()
+    void buildScene(const SceneBuilder &builder);
+    /// @brief Where the CPU traces go and how many frames they cover, before run()
+    inline void setTrace(const TraceSettings &settings) { trace = settings; }
+    /// @brief Bytes of transient memory per frame in flight (streamed vertices...), before run(). A frame needing more throws
+    void setFrameRingCapacity(VkDeviceSize capacity);
+    /// @brief Starts with the pipeline statistics on, as if checked in the UI
+    inline void enablePipelineStatistics(bool enabled) { interface.pipelineStatistics = enabled; }
+
+    // Getters
+    /// @brief Timings of every frame drawn, with a headless frame count only. Complete once run() returned
+    inline const std::vector<FrameTimings> &frameTimings() const { return timings; }
 };
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+#include "global.hpp"
+
+#include <functional>
+#include <vector>
+
+// Forward declaration
+class Device;
+
+/// @brief Everything a pre-recorded command buffer depends on. Any change means it has to be recorded again
+struct CommandKey
+{
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    /// @brief VK_NULL_HANDLE with dynamic rendering, the commands then work for every image
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    VkExtent2D extent = {0, 0};
+    /// @brief Handles of destroyed objects may be reused by their replacements : the render pass generation tells them apart
+    uint64_t generation = 0;
+    /// @brief Bumped by the owner whenever what it draws changes
+    uint64_t version = 0;
+
+    bool operator==(const CommandKey &other) const;
+};
+
+/// @brief Secondary command buffers recorded once and replayed every frame, until their key changes.
+/// Each slot holds one buffer (e.g one per framebuffer). Outdated buffers may still be pending in frames
+/// in flight, so they are freed through the deletion queue rather than reset.
+class CommandCache
+{
+private:
+    struct Entry
+    {
+        CommandKey key;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+    };
+
+    const Device &_device;
+
+    VkCommandPool _pool;
+    std::vector<Entry> _entries;
+
+    uint64_t _hits;
+    uint64_t _misses;
+
+public:
+    CommandCache(const Device &device);
+    ~CommandCache();
+
+    CommandCache(const CommandCache &) = delete;
+    CommandCache &operator=(const CommandCache &) = delete;
+
+    /// @brief Buffer of `slot` matching `key`, recorded through `record` first if it doesn't.
+    /// `record` gets a fresh secondary buffer, and has to begin and end it
+    VkCommandBuffer get(uint32_t slot, const CommandKey &key, const std::function<void(VkCommandBuffer)> &record);
+
+    /// @brief Drops every buffer, they are all recorded again on next use
+    void clear();
+
+    // Getters
+    inline uint64_t hits() const { return _hits; }
+    inline uint64_t misses() const { return _misses; }
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include "global.hpp"
+
+#include <vector>
+
+// Forward declaration
+class Device;
+
+/// @brief TRANSIENT command pool recycled as a whole : reset() rewinds every buffer in a single vkResetCommandPool,
+/// which drivers handle much faster than resetting buffers one by one.
+/// Buffers are allocated on first use and kept in a free list, so a warmed up pool never allocates.
+class CommandPool
+{
+private:
+    const Device &_device;
+
+    VkCommandPool _pool;
+    VkCommandBufferLevel _level;
+    /// @brief Every buffer allocated so far. The first `_used` ones are handed out since the last reset
+    std::vector<VkCommandBuffer> _buffers;
+    size_t _used;
+
+public:
+    CommandPool(const Device &device, uint32_t queueFamily, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+    ~CommandPool();
+
+    CommandPool(const CommandPool &) = delete;
+    CommandPool &operator=(const CommandPool &) = delete;
+
+    /// @brief Hands out a buffer ready to be begun, valid until the next reset()
+    VkCommandBuffer acquire();
+
+    /// @brief Rewinds every buffer handed out. The GPU must be done with all of them
+    void reset();
+
+    // Getters
+    inline const VkCommandPool &handle() const { return _pool; }
+    inline size_t used() const { return _used; }
+    inline size_t allocated() const { return _buffers.size(); }
+};
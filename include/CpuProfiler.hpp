@@ -0,0 +1,72 @@
+#pragma once
+#include "global.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+/// @brief Scoped CPU zones, for a Chrome/Perfetto trace of the last frames. Each thread writes its zones to its own ring,
+/// with no lock and nothing shared but the ring's head : a zone costs two clock reads and three stores.
+/// Zones go through the CPU_ZONE() macros, which build to nothing without VKBULLSHIT_PROFILER
+class CpuProfiler
+{
+public:
+    /// @brief Times in nanoseconds, on the steady clock
+    struct Zone
+    {
+        std::atomic<const char *> name;
+        std::atomic<uint64_t> start;
+        std::atomic<uint64_t> end;
+    };
+
+    /// @brief Closes its zone when going out of scope
+    class Scope
+    {
+    private:
+        const char *_name;
+        uint64_t _start;
+
+    public:
+        inline Scope(const char *name) : _name(name), _start(Now()) {}
+        inline ~Scope() { Record(_name, _start, Now()); }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+    /// @brief Whether the zones are built in, i.e VKBULLSHIT_PROFILER is defined
+    static const bool Enabled;
+    /// @brief Zones kept per thread, the oldest ones being overwritten
+    static const size_t ZonesPerThread;
+    /// @brief Frame starts kept, so the most frames a trace can cover
+    static const size_t FramesKept;
+
+    inline static uint64_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /// @brief Adds a finished zone to the calling thread's ring. `name` must outlive the profiler : a string literal
+    static void Record(const char *name, uint64_t start, uint64_t end);
+    /// @brief Names the calling thread in the traces
+    static void SetThreadName(const char *name);
+    /// @brief Marks the start of a frame. Only called by the thread driving the frames (the main one)
+    static void FrameMark();
+
+    /// @brief Writes the zones of the last `frames` frames, from every thread, as Chrome trace event JSON (chrome://tracing,
+    /// ui.perfetto.dev). Can run while other threads record : the zones overwritten meanwhile are left out
+    static void WriteTrace(const std::string &path, uint32_t frames);
+};
+
+#ifdef VKBULLSHIT_PROFILER
+#define CPU_ZONE_CONCAT_(a, b) a##b
+#define CPU_ZONE_CONCAT(a, b) CPU_ZONE_CONCAT_(a, b)
+/// @brief Zone from here to the end of the enclosing block
+#define CPU_ZONE(name) CpuProfiler::Scope CPU_ZONE_CONCAT(cpuZone, __LINE__)(name)
+#define CPU_THREAD_NAME(name) CpuProfiler::SetThreadName(name)
+#define CPU_FRAME_MARK() CpuProfiler::FrameMark()
+#else
+#define CPU_ZONE(name) ((void)0)
+#define CPU_THREAD_NAME(name) ((void)0)
+#define CPU_FRAME_MARK() ((void)0)
+#endif
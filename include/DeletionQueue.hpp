@@ -0,0 +1,61 @@
+#pragma once
+#include "global.hpp"
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// Forward declaration
+class Device;
+struct Buffer;
+struct Image;
+
+/// @brief Destroys Vulkan objects once the GPU can no longer be using them, without waiting for the device to be idle.
+/// Everything pushed is tagged with the next graphics timeline value, i.e. the submission being recorded,
+/// and destroyed once the GPU has reached it. Recording threads may push while the render thread records too.
+class DeletionQueue
+{
+private:
+    struct Entry
+    {
+        /// @brief Graphics timeline value after which the object is unused
+        uint64_t value;
+        std::function<void()> destroy;
+    };
+
+    const Device &_device;
+
+    std::deque<Entry> _entries;
+    mutable std::mutex _mutex;
+
+public:
+    DeletionQueue(const Device &device);
+    ~DeletionQueue();
+
+    /// @brief Destroys everything the GPU is done with. Cheap enough to be called every frame
+    void collect();
+
+    /// @brief Destroys everything right now. Only valid once the device is idle (shutdown)
+    void flush();
+
+    /// @brief Defers any destruction function to when the submission being recorded is done
+    void push(std::function<void()> destroy);
+
+    // Shortcuts for the usual handles
+    void destroyBuffer(const Buffer &buffer);
+    void destroyImage(const Image &image);
+    void destroyImageView(VkImageView imageView);
+    void destroyFramebuffer(VkFramebuffer framebuffer);
+    void destroyRenderPass(VkRenderPass renderPass);
+    void destroyPipeline(VkPipeline pipeline);
+    void destroyPipelineLayout(VkPipelineLayout layout);
+    void destroySwapChain(VkSwapchainKHR swapChain);
+    void destroySemaphore(VkSemaphore semaphore);
+    void freeCommandBuffers(VkCommandPool pool, std::vector<VkCommandBuffer> commandBuffers);
+
+    inline size_t pending() const
+    {
+        std::lock_guard lock(_mutex);
+        return _entries.size();
+    }
+};
@@ -3,9 +3,16 @@
 #include "QueueFamily.hpp"
 
 #include <vector>
+#include <memory>
 
 // Forward declaration
 class Window;
+class Allocator;
+class Uploader;
+class MemoryBudget;
+class DeletionQueue;
+class MemoryTypeTable;
+class Scheduler;
 
 class Device
 {
@@ -17,14 +24,53 @@ private:
 
     VkQueue _presentQueue;
     VkQueue _graphicsQueue;
+    /// @brief Queue used for uploads, the graphics queue when there is no dedicated transfer family
+    VkQueue _transferQueue;
+    uint32_t _transferFamily;
     QueueFamily _indices;
 
+    std::unique_ptr<MemoryTypeTable> _memoryTypes;
+    std::unique_ptr<Scheduler> _scheduler;
+    std::unique_ptr<Allocator> _allocator;
+    std::unique_ptr<Uploader> _uploader;
+    std::unique_ptr<MemoryBudget> _budget;
+    std::unique_ptr<DeletionQueue> _deletionQueue;
+
+    /// @brief Required extensions, plus the optional ones the device supports
+    std::vector<const char *> _enabledExtensions;
+    bool _memoryBudgetEnabled;
+    bool _dynamicRenderingEnabled;
+    /// @brief VK_KHR_present_id and VK_KHR_present_wait, both or none
+    bool _presentWaitEnabled;
+    /// @brief pipelineStatisticsQuery, for the vertex and fragment counts of each pass
+    bool _pipelineStatisticsEnabled;
+    /// @brief Nanoseconds per timestamp tick, 0 when the graphics queue can't write timestamps
+    float _timestampPeriod;
+    /// @brief Bits of a timestamp the graphics queue actually writes
+    uint64_t _timestampMask;
+
+    // VK_KHR_dynamic_rendering entry points, null when not enabled
+    PFN_vkCmdBeginRenderingKHR _cmdBeginRendering;
+    PFN_vkCmdEndRenderingKHR _cmdEndRendering;
+    // VK_KHR_present_wait entry point, null when not enabled
+    PFN_vkWaitForPresentKHR _waitForPresent;
+
     void pickPhysicalDevice();
     bool checkDeviceExtensionSupport(const VkPhysicalDevice &device);
+    /// @brief Vulkan 1.2 with timeline semaphores, which every submission relies on
+    bool checkTimelineSupport(const VkPhysicalDevice &device);
+    bool checkDynamicRenderingSupport(const VkPhysicalDevice &device);
+    bool checkPresentWaitSupport(const VkPhysicalDevice &device);
+    bool hasExtension(const VkPhysicalDevice &device, const char *name);
+    /// @brief Enables an optional extension if the device supports it
+    /// @return Whether it was enabled
+    bool enableOptionalExtension(const char *name, uint32_t minApiVersion = VK_API_VERSION_1_0);
     bool isDeviceSuitable(const VkPhysicalDevice &device);
+    void queryTimestampSupport();
 
 public:
     Device(const Window &window);
+    ~Device();
 
     // Getters
     inline const VkPhysicalDevice &physical() const { return _physical; }
@@ -32,4 +78,24 @@ public:
     inline const QueueFamily &queueFamilyIndices() const { return _indices; }
     inline const VkQueue &graphicsQueue() const { return _graphicsQueue; }
     inline const VkQueue &presentQueue() const { return _presentQueue; }
+    inline const VkQueue &transferQueue() const { return _transferQueue; }
+    inline uint32_t transferFamily() const { return _transferFamily; }
+    inline bool hasDedicatedTransfer() const { return _transferFamily != _indices.graphicsFamily.value(); }
+    inline const MemoryTypeTable &memoryTypes() const { return *_memoryTypes; }
+    inline Scheduler &scheduler() const { return *_scheduler; }
+    inline Allocator &allocator() const { return *_allocator; }
+    inline Uploader &uploader() const { return *_uploader; }
+    inline MemoryBudget &budget() const { return *_budget; }
+    inline DeletionQueue &deletionQueue() const { return *_deletionQueue; }
+    inline bool memoryBudgetEnabled() const { return _memoryBudgetEnabled; }
+    inline bool dynamicRenderingEnabled() const { return _dynamicRenderingEnabled; }
+    inline bool presentWaitEnabled() const { return _presentWaitEnabled; }
+    inline bool pipelineStatisticsEnabled() const { return _pipelineStatisticsEnabled; }
+    inline bool timestampsSupported() const { return _timestampPeriod > 0.0f; }
+    inline float timestampPeriod() const { return _timestampPeriod; }
+    inline uint64_t timestampMask() const { return _timestampMask; }
+    inline PFN_vkCmdBeginRenderingKHR cmdBeginRendering() const { return _cmdBeginRendering; }
+    inline PFN_vkCmdEndRenderingKHR cmdEndRendering() const { return _cmdEndRendering; }
+    inline PFN_vkWaitForPresentKHR waitForPresent() const { return _waitForPresent; }
+    inline const std::vector<const char *> &enabledExtensions() const { return _enabledExtensions; }
 };
\ No newline at end of file
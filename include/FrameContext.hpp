@@ -0,0 +1,67 @@
+#pragma once
+#include "global.hpp"
+
+#include <CommandPool.hpp>
+#include <memory/FrameRing.hpp>
+
+#include <memory>
+#include <vector>
+
+// Forward declaration
+class Device;
+
+/// @brief Everything a frame in flight needs for itself : its command pool, its acquire semaphore
+/// and its transient memory. Nothing in here is tied to the swapchain images, so the number of frames
+/// in flight can be chosen freely.
+class FrameContext
+{
+private:
+    const Device &_device;
+
+    /// @brief Graphics command buffers, all recycled at once when the frame comes back around
+    CommandPool _commandPool;
+    /// @brief Secondary buffers for what can't be cached, recycled the same way. One pool per recording thread,
+    /// as a pool can't be used by two threads at once
+    std::vector<std::unique_ptr<CommandPool>> _secondaryPools;
+
+    /// @brief Signaled when the swapchain image acquired for this frame is ready to be drawn to
+    VkSemaphore _imageAvailable;
+    /// @brief Graphics timeline value of this context's last submission, 0 if it never submitted
+    uint64_t _submission;
+
+    /// @brief Per-frame transient memory (streamed vertices, uniforms...)
+    FrameRing _ring;
+
+    uint64_t _frameNumber;
+
+public:
+    /// @brief Deepest pipelining allowed : more only adds latency
+    static const uint32_t MaxFramesInFlight;
+
+    /// @param recordingThreads Threads allowed to record secondary buffers for this frame
+    /// @param ringCapacity Bytes of per-frame transient memory, a frame needing more fails to record
+    FrameContext(const Device &device, uint32_t recordingThreads = 1, VkDeviceSize ringCapacity = FrameRing::DefaultCapacity);
+    ~FrameContext();
+
+    FrameContext(const FrameContext &) = delete;
+    FrameContext &operator=(const FrameContext &) = delete;
+
+    /// @brief Blocks until the GPU is done with the last submission made with this context
+    void wait() const;
+    /// @brief Whether the GPU is done with this context, without blocking
+    bool done() const;
+    /// @brief Records the graphics timeline value of the submission made with this context
+    inline void submitted(uint64_t value) { _submission = value; }
+    /// @brief Recycles the context for frame `frameNumber`. Must be called after wait()
+    void begin(uint64_t frameNumber);
+
+    // Getters
+    inline CommandPool &commandPool() { return _commandPool; }
+    /// @brief Secondary pool of recording thread `thread`, its JobSystem::ThreadIndex(). The render thread submitting the
+    /// frame is an adopted one, last of the job system
+    inline CommandPool &secondaryPool(uint32_t thread) { return *_secondaryPools[thread]; }
+    inline const VkSemaphore &imageAvailable() const { return _imageAvailable; }
+    inline uint64_t submission() const { return _submission; }
+    inline FrameRing &ring() { return _ring; }
+    inline uint64_t frameNumber() const { return _frameNumber; }
+};
@@ -0,0 +1,30 @@
+#pragma once
+#include "global.hpp"
+
+#include <chrono>
+
+/// @brief Caps a loop to a number of iterations per second. Deadlines are kept on a fixed grid,
+/// so that oversleeping on one frame is made up for on the next ones instead of drifting
+class FrameLimiter
+{
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::duration _period;
+    Clock::time_point _deadline;
+
+public:
+    /// @brief The OS scheduler may oversleep by about this much : the end of each wait is spun instead
+    static const Clock::duration SpinMargin;
+
+    FrameLimiter();
+
+    /// @brief 0 removes the cap
+    void setTargetFps(uint32_t fps);
+
+    /// @brief Blocks until the next deadline. Returns right away if there is no cap, or if the loop is already late
+    void wait();
+
+    // Getters
+    inline bool capped() const { return _period != Clock::duration::zero(); }
+};
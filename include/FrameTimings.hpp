@@ -0,0 +1,25 @@
+#pragma once
+#include "global.hpp"
+
+#include <GpuProfiler.hpp>
+#include <PipelineStatistics.hpp>
+
+#include <vector>
+
+/// @brief Where the time of one drawn frame went, measured by the render thread
+struct FrameTimings
+{
+    uint64_t frameNumber = 0;
+    /// @brief Whole frame on the render thread, from waiting for its context to presenting
+    double cpuMs = 0.0;
+    /// @brief Recording its command buffers, scene and UI
+    double recordMs = 0.0;
+    /// @brief The graphics submission alone
+    double submitMs = 0.0;
+    /// @brief Its commands on the GPU, negative when the queue has no timestamps
+    double gpuMs = -1.0;
+    /// @brief GPU time of each profiler scope of the frame, the frame itself first. Empty without timestamps
+    std::vector<GpuScopeResult> gpuScopes;
+    /// @brief Pipeline statistics of each pass, empty unless they were on
+    std::vector<PassStatistics> passStatistics;
+};
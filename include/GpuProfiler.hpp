@@ -0,0 +1,85 @@
+#pragma once
+#include "global.hpp"
+#include "QueryRing.hpp"
+
+#include <memory>
+#include <vector>
+
+// Forward declaration
+class Device;
+
+/// @brief GPU time of one scope of a frame
+struct GpuScopeResult
+{
+    /// @brief As given to GpuProfiler::begin()
+    const char *name = nullptr;
+    /// @brief Nesting level, 0 for the frame itself
+    uint32_t depth = 0;
+    double ms = 0.0;
+};
+
+/// @brief Every scope of a frame, in the order they were opened : the frame itself comes first
+struct GpuFrameResult
+{
+    uint64_t frameNumber = 0;
+    std::vector<GpuScopeResult> scopes;
+};
+
+/// @brief Nestable GPU timing scopes, through timestamp queries read back from a QueryRing.
+/// Recording is render thread only, the history can be read from any thread.
+/// Does nothing when the graphics queue can't write timestamps
+class GpuProfiler
+{
+private:
+    struct Scope
+    {
+        const char *name;
+        uint32_t depth;
+    };
+
+    const Device &_device;
+
+    /// @brief Null when timestamps aren't supported
+    std::unique_ptr<QueryRing> _ring;
+    /// @brief Scopes of each frame of the ring : scope i writes queries 2i (begin) and 2i + 1 (end)
+    std::vector<std::vector<Scope>> _scopes;
+    /// @brief Scopes of the frame being recorded, null outside of one
+    std::vector<Scope> *_current;
+    /// @brief Scopes of the current frame opened and not closed yet, innermost last. MaxScopes for the ones over the limit
+    std::vector<uint32_t> _open;
+
+    QueryHistory<GpuFrameResult> _history;
+
+public:
+    /// @brief Scopes per frame, the frame itself included. Scopes past it are left out
+    static const uint32_t MaxScopes;
+    /// @brief Frames kept by history()
+    static const size_t HistoryLength;
+
+    GpuProfiler(const Device &device);
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler &) = delete;
+    GpuProfiler &operator=(const GpuProfiler &) = delete;
+
+    /// @brief Starts frame `frameNumber` on its primary command buffer, outside any pass, and opens its root scope.
+    /// Whatever the pool held and wasn't collected is dropped
+    void beginFrame(VkCommandBuffer commandBuffer, uint64_t frameNumber);
+    /// @brief Closes every scope still open, the root one included
+    void endFrame(VkCommandBuffer commandBuffer);
+
+    /// @brief Opens a scope inside the current one, on any command buffer executed within the frame's primary.
+    /// `name` must outlive the profiler : a string literal
+    void begin(VkCommandBuffer commandBuffer, const char *name);
+    /// @brief Closes the innermost scope
+    void end(VkCommandBuffer commandBuffer);
+
+    /// @brief Reads back every frame the GPU is done with, without blocking. Added to the history, and returned oldest first
+    std::vector<GpuFrameResult> collect();
+
+    /// @brief Copy of the last frames read back, oldest first
+    std::vector<GpuFrameResult> history() const;
+
+    // Getters
+    inline bool enabled() const { return _ring != nullptr; }
+};
@@ -1,6 +1,8 @@
 #pragma once
 #include "global.hpp"
 
+#include <geometry/Vertex.hpp>
+
 #include <vector>
 
 struct ShaderInfo
@@ -18,11 +20,9 @@ class RenderPass;
 class GraphicsPipeline
 {
 public:
-    GraphicsPipeline(const Device &device, const SwapChain &swapChain, const RenderPass &renderPass, const std::vector<ShaderInfo> shaders);
+    GraphicsPipeline(const Device &device, const SwapChain &swapChain, const RenderPass &renderPass, const std::vector<ShaderInfo> shaders, VertexInputDescription vertexInput = Vertex::Layout::Description());
     ~GraphicsPipeline();
 
-    void recreate();
-
     inline const VkPipeline &pipeline() const { return _pipeline; }
     inline const VkPipelineLayout &layout() const { return _layout; }
 
@@ -36,6 +36,7 @@ private:
     const RenderPass &_renderPass;
 
     const std::vector<ShaderInfo> _shaders;
+    const VertexInputDescription _vertexInput;
 
     void createPipeline();
     VkShaderModule createShaderModule(const ShaderInfo &shader);
@@ -0,0 +1,103 @@
+#pragma once
+#include "global.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief Number of unfinished jobs of a group. Jobs can depend on others by waiting on their counter
+class JobCounter
+{
+private:
+    std::atomic<uint32_t> _pending{0};
+    /// @brief First exception thrown by one of the jobs, rethrown by JobSystem::wait()
+    std::exception_ptr _error;
+    std::atomic<bool> _failed{false};
+
+    friend class JobSystem;
+
+public:
+    inline bool done() const { return _pending.load(std::memory_order_acquire) == 0; }
+};
+
+/// @brief Work-stealing job scheduler. Every thread has its own deque : it pushes and pops at the back (hot caches, LIFO),
+/// while idle threads steal from the front of the others'. The main thread is thread 0 and runs jobs whenever it waits.
+/// Jobs touching GLFW (or anything else bound to the main thread) are queued apart, and only run by the main thread.
+class JobSystem
+{
+public:
+    using Job = std::function<void()>;
+
+private:
+    struct Task
+    {
+        Job job;
+        JobCounter *counter = nullptr;
+    };
+
+    /// @brief Deque of one thread. A lock per deque keeps stealing simple, and is hardly ever contended
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::thread> _workers;
+    /// @brief One per thread : the main one, the workers, then the adopted ones
+    std::vector<std::unique_ptr<WorkQueue>> _queues;
+    uint32_t _adoptedThreads;
+    WorkQueue _mainQueue;
+
+    /// @brief Tasks sitting in the deques, so that idle workers know when to go to sleep
+    std::atomic<uint32_t> _queued;
+    std::atomic<uint32_t> _sleeping;
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    std::atomic<bool> _stopping;
+
+    void workerLoop(uint32_t thread);
+    void push(WorkQueue &queue, Task task);
+    /// @brief Pops from the deque of `thread`, or steals from another one. False if there was nothing to run
+    bool runOne(uint32_t thread);
+    static void Execute(Task &task);
+
+public:
+    /// @brief Worker count picking one worker per core besides the main thread's
+    static const uint32_t AutoWorkers;
+
+    /// @param workerCount Threads besides the main one, or AutoWorkers. With 0, jobs only run on the threads waiting for them
+    /// @param adoptedThreads Threads created elsewhere (e.g the render thread) that also queue or wait for jobs
+    JobSystem(uint32_t workerCount = AutoWorkers, uint32_t adoptedThreads = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    /// @brief Queues `job` on the calling thread's deque. `counter`, if any, is only done once the job has run
+    void run(Job job, JobCounter *counter = nullptr);
+    /// @brief Queues `job` for the main thread only, run on its next pumpMain() or wait()
+    void runOnMain(Job job, JobCounter *counter = nullptr);
+    /// @brief Runs `body(first, last)` over [0, count) in slices of `grain` items, and waits for all of them
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t first, size_t last)> &body);
+
+    /// @brief Runs other jobs until every job counted in `counter` is done, then rethrows the first exception they threw
+    void wait(const JobCounter &counter);
+    /// @brief Runs the jobs queued for the main thread. Main thread only
+    void pumpMain();
+    /// @brief Gives the calling thread the deque of adopted thread `slot`, to be called first thing on that thread.
+    /// Otherwise it would share the main thread's index, and run jobs meant for the main thread only
+    void adoptThread(uint32_t slot);
+
+    // Getters
+    /// @brief Threads running jobs, the main one included
+    inline uint32_t threadCount() const { return static_cast<uint32_t>(_queues.size()); }
+
+    /// @brief Index of the calling thread in [0, threadCount()), 0 being the main thread
+    static uint32_t ThreadIndex();
+};
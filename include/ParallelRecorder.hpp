@@ -0,0 +1,72 @@
+#pragma once
+#include "global.hpp"
+#include "CommandCache.hpp"
+
+#include <memory>
+#include <span>
+#include <vector>
+
+// Forward declaration
+class Device;
+class Renderer;
+struct DrawState;
+class RenderPass;
+class FrameContext;
+class JobSystem;
+class JobCounter;
+class PipelineStatistics;
+
+/// @brief Records a draw list on the job system. The list is cut in contiguous chunks, each recorded into a secondary
+/// buffer from the running thread's own pool in the frame context, so no pool is ever used by two threads.
+/// Executing the buffers in order draws the same thing as recording the list on a single thread.
+/// A chunk of cacheable renderers is recorded once and replayed, like a single renderer's buffer, until one of them changes.
+class ParallelRecorder
+{
+private:
+    /// @brief Cached buffers of one chunk, one per cache slot, and what each was recorded from
+    struct Chunk
+    {
+        CommandCache cache;
+        /// @brief Per slot : id and key of every renderer in the buffer, in draw order
+        std::vector<std::vector<std::pair<uint64_t, CommandKey>>> members;
+        /// @brief Per slot, bumped whenever the members change : the version of the slot's key
+        std::vector<uint64_t> versions;
+
+        Chunk(const Device &device) : cache(device) {}
+    };
+
+    const Device &_device;
+    JobSystem &_jobs;
+
+    /// @brief One buffer per chunk, in draw order
+    std::vector<VkCommandBuffer> _commandBuffers;
+    /// @brief Indexed by chunk. Each is only used by the thread recording its chunk
+    std::vector<std::unique_ptr<Chunk>> _chunks;
+
+    /// @brief Cached buffer of `chunk` drawing `renderers`, recorded first if they changed since the last one
+    VkCommandBuffer recordCached(Chunk &chunk, FrameContext &frame, const RenderPass &renderPass, uint32_t subpass, uint32_t imageIndex,
+                                 std::span<Renderer *const> renderers, std::span<const DrawState> states);
+
+public:
+    /// @brief Below this many draws per chunk, handing the chunk to another thread costs more than recording the draws
+    static const size_t MinDrawsPerChunk;
+    /// @brief Chunks per thread : a few more than threads lets the ones done early steal from the others
+    static const uint32_t ChunksPerThread;
+
+    ParallelRecorder(const Device &device, JobSystem &jobs);
+
+    ParallelRecorder(const ParallelRecorder &) = delete;
+    ParallelRecorder &operator=(const ParallelRecorder &) = delete;
+
+    /// @brief Starts recording `renderers`, each as of its state in `states`, for `subpass` of image `imageIndex`.
+    /// The buffers are ready once `counter` is done.
+    /// A list too small to be worth splitting goes through each renderer's cache instead, right away on the calling thread.
+    /// `renderers` and `states` must outlive the recording. While `statistics` records, every buffer counts its draws as `pass`, and none is cached.
+    /// Cached chunks aren't told subpasses apart : one recorder per subpass
+    void record(FrameContext &frame, const RenderPass &renderPass, uint32_t subpass, uint32_t imageIndex,
+                std::span<Renderer *const> renderers, std::span<const DrawState> states, JobCounter &counter, PipelineStatistics *statistics = nullptr, const char *pass = nullptr);
+
+    // Getters
+    /// @brief Secondary buffers to execute, in order, once the last record() is done. Valid until the next one
+    inline std::span<const VkCommandBuffer> commandBuffers() const { return _commandBuffers; }
+};
@@ -0,0 +1,97 @@
+#pragma once
+#include "global.hpp"
+#include "QueryRing.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Forward declaration
+class Device;
+
+/// @brief What the GPU did for one pass of a frame, summed over every buffer of the pass
+struct PassStatistics
+{
+    /// @brief As given to PipelineStatistics::begin()
+    const char *name = nullptr;
+    uint64_t inputVertices = 0;
+    uint64_t vertexInvocations = 0;
+    /// @brief Primitives reaching the clipping stage, and the ones coming out of it : fewer out means culled or clipped away
+    uint64_t clippingInvocations = 0;
+    uint64_t clippingPrimitives = 0;
+    /// @brief Compared to the pixels of the target, how much overdraw there is
+    uint64_t fragmentInvocations = 0;
+};
+
+/// @brief Every pass of a frame, sorted by name
+struct FrameStatistics
+{
+    uint64_t frameNumber = 0;
+    std::vector<PassStatistics> passes;
+};
+
+/// @brief Pipeline statistics queries around the secondary buffers of each pass. A query has to begin and end in the same
+/// command buffer, and passes executing secondary buffers can't record anything else : each buffer gets its own query,
+/// summed by pass once read back. Cached buffers can't point to the queries of a frame, so they are recorded again while
+/// the statistics are on, hence them being off by default.
+/// Read back from a QueryRing, like GpuProfiler : a few frames late. Does nothing without pipelineStatisticsQuery
+class PipelineStatistics
+{
+private:
+    const Device &_device;
+
+    /// @brief Null when pipeline statistics aren't supported
+    std::unique_ptr<QueryRing> _ring;
+    /// @brief Pass of each query begun, per frame of the ring, written by the thread that took it. MaxQueries long
+    std::vector<std::vector<const char *>> _passes;
+    /// @brief Passes of the frame being recorded, null outside of one
+    std::vector<const char *> *_current;
+    /// @brief Queries taken by the frame being recorded, past MaxQueries included
+    std::atomic<uint32_t> _used;
+    bool _active;
+
+    QueryHistory<FrameStatistics> _history;
+
+public:
+    /// @brief Queries per frame. Buffers past it aren't counted
+    static const uint32_t MaxQueries;
+    /// @brief Frames kept by history()
+    static const size_t HistoryLength;
+    /// @brief Counters written per query, in the order of PassStatistics
+    static const VkQueryPipelineStatisticFlags Counters;
+    /// @brief Returned by begin() when nothing is counted
+    static const uint32_t NoQuery;
+
+    PipelineStatistics(const Device &device);
+    ~PipelineStatistics();
+
+    PipelineStatistics(const PipelineStatistics &) = delete;
+    PipelineStatistics &operator=(const PipelineStatistics &) = delete;
+
+    /// @brief Turns the queries on or off from the next frame on
+    void setActive(bool active);
+
+    /// @brief Starts frame `frameNumber` on its primary command buffer, outside any pass.
+    /// Whatever the pool held and wasn't collected is dropped
+    void beginFrame(VkCommandBuffer commandBuffer, uint64_t frameNumber);
+    /// @brief Every buffer of the frame is recorded
+    void endFrame();
+
+    /// @brief Starts counting the commands of a secondary buffer of `pass`, right after beginning it. Any recording thread.
+    /// `pass` must outlive the statistics : a string literal
+    uint32_t begin(VkCommandBuffer commandBuffer, const char *pass);
+    /// @brief Stops counting, right before ending the buffer
+    void end(VkCommandBuffer commandBuffer, uint32_t query);
+
+    /// @brief Reads back every frame the GPU is done with, without blocking. Added to the history, and returned oldest first
+    std::vector<FrameStatistics> collect();
+
+    /// @brief Copy of the last frames read back, oldest first
+    std::vector<FrameStatistics> history() const;
+
+    // Getters
+    inline bool supported() const { return _ring != nullptr; }
+    /// @brief Whether the frame being recorded counts its passes
+    inline bool recording() const { return _current != nullptr; }
+    inline bool active() const { return _active; }
+};
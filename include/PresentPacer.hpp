@@ -0,0 +1,47 @@
+#pragma once
+#include "global.hpp"
+
+// Forward declaration
+class Device;
+class SwapChain;
+
+/// @brief Latency limiter built on VK_KHR_present_id / VK_KHR_present_wait. Every present gets an id,
+/// and wait() blocks until few enough of them are still queued : the frame started right after is then
+/// recorded from the freshest input, just in time for the next vblank, instead of sitting in the queue.
+/// Does nothing when the device doesn't support present wait.
+class PresentPacer
+{
+private:
+    const Device &_device;
+    const SwapChain &_swapChain;
+
+    /// @brief Frames allowed to wait for presentation, 0 disables the limiter
+    uint32_t _maxQueuedFrames;
+
+    /// @brief Id of the last present, ids never go back even across swapchains
+    uint64_t _lastId;
+    /// @brief First id presented with `_presented`. Ids of an older swapchain will never complete on the new one
+    uint64_t _firstId;
+    VkSwapchainKHR _presented;
+
+    /// @brief Chained to the present info, which only holds a pointer to it
+    VkPresentIdKHR _presentId;
+
+public:
+    /// @brief Longest wait for a present, in nanoseconds. A present that never completes (minimized window...) must not hang the frame
+    static const uint64_t Timeout;
+
+    PresentPacer(const Device &device, const SwapChain &swapChain);
+
+    /// @brief Chains the id of the next present to `presentInfo`, valid until the next call
+    void attach(VkPresentInfoKHR &presentInfo);
+
+    /// @brief Blocks until at most `maxQueuedFrames() - 1` presents are queued, so that the next one is the last allowed
+    void wait();
+
+    inline void setMaxQueuedFrames(uint32_t count) { _maxQueuedFrames = count; }
+
+    // Getters
+    bool enabled() const;
+    inline uint32_t maxQueuedFrames() const { return _maxQueuedFrames; }
+};
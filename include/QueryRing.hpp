@@ -0,0 +1,94 @@
+#pragma once
+#include "global.hpp"
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+// Forward declaration
+class Device;
+
+/// @brief One query pool per frame, out of a ring longer than frames can be in flight : by the time a pool comes back
+/// around its results are in, so they are read without ever waiting, a few frames late.
+/// Render thread only, but for writing queries to the pool of the frame being recorded
+class QueryRing
+{
+private:
+    struct Slot
+    {
+        VkQueryPool pool = VK_NULL_HANDLE;
+        uint64_t frameNumber = 0;
+        /// @brief Queries written by the frame, the first ones of the pool
+        uint32_t queryCount = 0;
+        /// @brief Recorded, but not read back yet
+        bool pending = false;
+    };
+
+    const Device &_device;
+
+    std::vector<Slot> _slots;
+    Slot *_current;
+    uint32_t _poolSize;
+    uint32_t _valuesPerQuery;
+    std::vector<uint64_t> _values;
+
+public:
+    /// @brief Query pools in the ring
+    static const uint32_t FrameLatency;
+
+    /// @brief Ring of pools created from `queryPoolInfo`, each query writing `valuesPerQuery` 64 bit values
+    QueryRing(const Device &device, const VkQueryPoolCreateInfo &queryPoolInfo, uint32_t valuesPerQuery);
+    ~QueryRing();
+
+    QueryRing(const QueryRing &) = delete;
+    QueryRing &operator=(const QueryRing &) = delete;
+
+    /// @brief Starts frame `frameNumber` on its primary command buffer, outside any pass, by resetting its pool.
+    /// Whatever the pool held and wasn't collected is dropped. Returns the slot of the frame, to keep what goes with its queries
+    uint32_t beginFrame(VkCommandBuffer commandBuffer, uint64_t frameNumber);
+    /// @brief The frame is recorded, and wrote its first `queryCount` queries
+    void endFrame(uint32_t queryCount);
+
+    /// @brief Calls `read` for every frame the GPU is done with, oldest first, without blocking.
+    /// `values` holds the values of each query in turn, and is only valid during the call
+    void collect(const std::function<void(uint32_t slot, uint64_t frameNumber, const uint64_t *values, uint32_t queryCount)> &read);
+
+    // Getters
+    /// @brief Pool of the frame being recorded
+    inline VkQueryPool pool() const { return _current->pool; }
+    /// @brief Whether a frame is being recorded
+    inline bool recording() const { return _current != nullptr; }
+};
+
+/// @brief Last frames read back from a QueryRing, oldest first. Added to by the render thread, read from any thread
+template <typename Result>
+class QueryHistory
+{
+private:
+    std::deque<Result> _frames;
+    size_t _length;
+    mutable std::mutex _mutex;
+
+public:
+    QueryHistory(size_t length) : _length(length) {}
+
+    /// @brief Adds `results`, oldest first, dropping the frames past the length
+    void push(const std::vector<Result> &results)
+    {
+        std::lock_guard lock(_mutex);
+        for (const Result &result : results)
+        {
+            _frames.push_back(result);
+            if (_frames.size() > _length)
+                _frames.pop_front();
+        }
+    }
+
+    /// @brief Copy of the frames kept, oldest first
+    std::vector<Result> copy() const
+    {
+        std::lock_guard lock(_mutex);
+        return {_frames.begin(), _frames.end()};
+    }
+};
@@ -8,6 +8,8 @@ struct QueueFamily
 {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    /// @brief Transfer-capable family without graphics support, if the device exposes one (DMA engine)
+    std::optional<uint32_t> transferFamily;
 
     QueueFamily();
     QueueFamily(VkPhysicalDevice device, VkSurfaceKHR surface);
@@ -0,0 +1,39 @@
+#pragma once
+#include "global.hpp"
+
+#include <memory/Allocator.hpp>
+
+#include <string>
+
+// Forward declaration
+class Device;
+class SwapChain;
+
+/// @brief Copies a swapchain image back to host memory, to look at what was rendered without a display.
+/// The swapchain must be created with TRANSFER_SRC usage
+class Readback
+{
+private:
+    const Device &_device;
+    const SwapChain &_swapChain;
+
+    /// @brief Host visible copy of the image, grown as needed
+    Buffer _buffer;
+    /// @brief Extent and format of the last recorded copy
+    VkExtent2D _extent;
+    VkFormat _format;
+
+public:
+    Readback(const Device &device, const SwapChain &swapChain);
+    ~Readback();
+
+    Readback(const Readback &) = delete;
+    Readback &operator=(const Readback &) = delete;
+
+    /// @brief Records a copy of image `imageIndex`, after the render pass left it ready for presentation,
+    /// and hands the image back to presentation. 8 bit RGBA and BGRA formats only
+    void record(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+
+    /// @brief Writes the last copy as a binary PPM image. The submission that recorded it must be done
+    void save(const std::string &path) const;
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include "global.hpp"
+
+#include <Renderer.hpp>
+#include <ui/UIDrawData.hpp>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+/// @brief Everything the render thread needs to draw a frame, built by the main thread one frame ahead.
+/// Left untouched by the main thread once published, the render thread only reads it. The renderers themselves keep
+/// changing on the main thread meanwhile : what may change is copied in `drawStates`
+struct RenderPacket
+{
+    /// @brief Main thread frame that built the packet
+    uint64_t frameNumber = 0;
+    /// @brief Draw list of the scene subpass
+    std::vector<Renderer *> drawList;
+    /// @brief State of each renderer of `drawList` when the packet was built
+    std::vector<DrawState> drawStates;
+    /// @brief UI of the frame, drawn in the overlay subpass
+    UIDrawData ui;
+    /// @brief Frames in flight asked for through the UI
+    uint32_t framesInFlight = 1;
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+    /// @brief Setting of the latency limiter, 0 disables it
+    uint32_t maxQueuedFrames = 0;
+    /// @brief Framebuffer resizes seen so far : a counter rather than a flag, as packets may be skipped
+    uint64_t resizeCount = 0;
+    /// @brief Framebuffer size when the packet was built, for the swapchain extent
+    glm::ivec2 framebufferSize = glm::ivec2(0, 0);
+    /// @brief Whether the passes count their vertices and fragments, see PipelineStatistics
+    bool pipelineStatistics = false;
+};
@@ -7,31 +7,65 @@
 class Device;
 class SwapChain;
 
+/// @brief Rendering to the swapchain images, through one of two backends :
+/// - a VkRenderPass and one framebuffer per image. Resizes only rebuild the framebuffers
+/// - dynamic rendering (VK_KHR_dynamic_rendering), straight on the image views with explicit layout barriers.
+///   No object at all, so resizes rebuild nothing and pipelines only depend on the attachment formats
 class RenderPass
 {
 protected:
     VkRenderPass _renderPass;
-    VkRenderPass _oldRenderPass;
 
     std::vector<VkFramebuffer> _frameBuffers;
 
     const Device &_device;
     const SwapChain &_swapChain;
 
+    bool _dynamic;
+    /// @brief Swapchain format the render pass was created for, the only thing it depends on
+    VkFormat _format;
+    /// @brief Number of recreations so far
+    uint64_t _generation;
+    /// @brief Contents of the rendering begun last, dynamic rendering has to restart to change them
+    mutable VkSubpassContents _contents;
+
+    /// @brief Dynamic rendering equivalent of vkCmdBeginRenderPass
+    void beginRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, VkAttachmentLoadOp loadOp, VkSubpassContents contents) const;
+
     virtual void createRenderPass() = 0;
     void createFrameBuffers();
 
     void destroyFrameBuffers();
 
 public:
-    RenderPass(const Device &device, const SwapChain &swapChain);
+    RenderPass(const Device &device, const SwapChain &swapChain, bool dynamic = false);
     ~RenderPass();
 
+    /// @brief Matches the current swapchain : new framebuffers, the old ones being destroyed once unused.
+    /// Throws if the image format changed, which nothing built against the pass would follow
     void recreate();
-    void cleanupOld();
+
+    /// @brief Begins the pass on swapchain image `imageIndex`, over the whole image, cleared to black
+    void begin(VkCommandBuffer commandBuffer, uint32_t imageIndex, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE) const;
+    /// @brief Moves on to the next subpass. With dynamic rendering, all subpasses share the same rendering,
+    /// which is only restarted (loading the image back) when the contents change
+    void nextSubpass(VkCommandBuffer commandBuffer, uint32_t imageIndex, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE) const;
+    /// @brief Ends the pass, leaving the image ready to be presented
+    void end(VkCommandBuffer commandBuffer, uint32_t imageIndex) const;
+
+    /// @brief Begins a secondary command buffer executed inside `subpass`, targeting image `imageIndex`
+    /// @param flags Usage flags on top of RENDER_PASS_CONTINUE
+    void beginSecondary(VkCommandBuffer commandBuffer, uint32_t subpass, uint32_t imageIndex, VkCommandBufferUsageFlags flags = 0) const;
+
+    /// @brief Format of the color attachment, what pipelines are created against with dynamic rendering
+    VkFormat colorFormat() const;
+    /// @brief What commands recorded for image `imageIndex` depend on : its framebuffer, nothing with dynamic rendering
+    VkFramebuffer target(uint32_t imageIndex) const;
 
     // Getters
     inline const VkRenderPass &handle() const { return _renderPass; }
     inline const VkFramebuffer &frameBuffer(uint32_t index) const { return _frameBuffers[index]; }
     inline size_t size() const { return _frameBuffers.size(); }
+    inline bool dynamic() const { return _dynamic; }
+    inline uint64_t generation() const { return _generation; }
 };
\ No newline at end of file
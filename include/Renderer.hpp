@@ -1,5 +1,8 @@
 #pragma once
 #include "global.hpp"
+#include "CommandCache.hpp"
+
+#include <geometry/Vertex.hpp>
 
 #include <vector>
 #include <functional>
@@ -9,36 +12,66 @@ class Device;
 class RenderPass;
 class SwapChain;
 class GraphicsPipeline;
+class FrameContext;
+class PipelineStatistics;
+
+/// @brief What a renderer draws that may change from one frame to the next. Copied into the render packet by the main
+/// thread, which is the only one editing renderers : recording reads the copy, never the renderer's live state
+struct DrawState
+{
+    /// @brief Renderer version when copied, part of the cache key
+    uint64_t version = 0;
+    uint32_t instanceCount = 1;
+    /// @brief Vertices streamed through the frame ring, empty to draw the renderer's static buffers
+    std::vector<Vertex> streamedVertices;
+};
 
+/// @brief Records draw commands into secondary command buffers. Unless the renderer says otherwise, they are
+/// recorded once and replayed until the pipeline, the target or the renderer's version changes.
+/// Per-frame buffers belong to the FrameContext being recorded.
 class Renderer
 {
 protected:
-    std::vector<VkCommandBuffer> _commandBuffers;
-
-    VkCommandPool _pool;
-    VkCommandPoolCreateFlags _flags;
-
     const Device &_device;
     const RenderPass &_renderPass;
     const SwapChain &_swapChain;
     const GraphicsPipeline &_graphicsPipeline;
 
-    virtual void createCommandBuffers() = 0;
-    void destroyCommandBuffers();
+    CommandCache _cache;
+    /// @brief Version of what is drawn, part of the cache key
+    uint64_t _version;
+    /// @brief Unique over the program's lifetime, unlike the renderer's address
+    const uint64_t _id;
 
 public:
-    Renderer(const Device &device, const RenderPass &renderPass, const SwapChain &swapChain, const GraphicsPipeline &graphicsPipeline, const VkCommandPoolCreateFlags &flags);
-    ~Renderer();
+    Renderer(const Device &device, const RenderPass &renderPass, const SwapChain &swapChain, const GraphicsPipeline &graphicsPipeline);
+    virtual ~Renderer() = default;
+
+    /// @brief Copies what this frame draws into `state`, reusing its allocations. Main thread, when building the packet
+    virtual void captureState(DrawState &state) const;
+
+    /// @brief Records the draws of this renderer, as of `state`, inside the subpass currently begun on `commandBuffer`.
+    /// The pass itself is begun and ended by the frame, so that several renderers share one load/store of the target.
+    /// May be called from any recording thread, alongside other renderers : only read `state` and what never changes
+    /// after construction, and allocate from the frame ring
+    virtual void record(VkCommandBuffer commandBuffer, FrameContext &frame, const DrawState &state) = 0;
+
+    /// @brief Whether the commands recorded for `state` stay valid across frames. False when they reference per-frame data
+    virtual bool cacheable(const DrawState &state) const { return true; }
+    /// @brief Invalidates the recorded commands, for when what is drawn changes. Main thread
+    inline void markDirty() { _version++; }
+    /// @brief What commands recorded for image `imageIndex` from `state` depend on
+    CommandKey cacheKey(uint32_t imageIndex, const DrawState &state) const;
 
-    void recreateCommandBuffers();
-    /// @brief Records command buffer at given index. For fixed geometry, no need to re-record multiple times.
-    /// @param index
-    virtual void recordCommandBuffer(uint32_t index);
+    /// @brief Secondary command buffer with this renderer's draws for `subpass` of image `imageIndex`,
+    /// taken from the cache when possible, recorded in `frame` otherwise.
+    /// While `statistics` records, always recorded in `frame`, with a query of `pass` around the draws
+    VkCommandBuffer secondary(FrameContext &frame, uint32_t subpass, uint32_t imageIndex, const DrawState &state,
+                              PipelineStatistics *statistics = nullptr, const char *pass = nullptr);
 
     // Getters
-    inline const VkCommandPool &pool() const { return _pool; };
-    inline VkCommandBuffer &command(uint32_t index) { return _commandBuffers[index]; }
-    inline const VkCommandBuffer &command(uint32_t index) const { return _commandBuffers[index]; }
+    inline const CommandCache &cache() const { return _cache; }
+    inline uint64_t id() const { return _id; }
 
     static void SingleTimeCommands(const Device &device, VkCommandPool &pool, const std::function<void(const VkCommandBuffer &)> &func);
 };
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+#include "global.hpp"
+#include "Timeline.hpp"
+
+#include <array>
+#include <initializer_list>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Forward declaration
+class Device;
+
+/// @brief Queues submissions go to. Each one has its own timeline
+enum class QueueType
+{
+    Graphics,
+    Transfer,
+};
+
+/// @brief Something a submission waits on : a timeline value, or a binary semaphore (`value` ignored)
+struct SemaphoreWait
+{
+    VkSemaphore semaphore = VK_NULL_HANDLE;
+    uint64_t value = 0;
+    VkPipelineStageFlags stages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+};
+
+/// @brief Submits to every queue through timeline semaphores : each submission signals the next value of its
+/// queue's timeline, and any later submission or host wait can refer to it by that value, on any queue.
+/// Binary semaphores are only used where the swapchain requires them (acquire and present).
+class Scheduler
+{
+private:
+    const Device &_device;
+
+    std::array<Timeline, 2> _timelines;
+
+    // Reused between submissions, so submitting doesn't allocate once warmed up
+    std::vector<VkSemaphore> _waitSemaphores;
+    std::vector<uint64_t> _waitValues;
+    std::vector<VkPipelineStageFlags> _waitStages;
+    std::vector<VkSemaphore> _signalSemaphores;
+    std::vector<uint64_t> _signalValues;
+
+    VkQueue queue(QueueType type) const;
+
+public:
+    Scheduler(const Device &device);
+
+    /// @brief Submits `commandBuffers` to `type`'s queue
+    /// @param waits Timeline values (of any queue) and binary semaphores to wait on
+    /// @param binarySignals Binary semaphores to signal along with the timeline, for presentation
+    /// @return Timeline value signaled once the submission is done
+    uint64_t submit(QueueType type, std::span<const VkCommandBuffer> commandBuffers,
+                    std::span<const SemaphoreWait> waits = {}, std::span<const VkSemaphore> binarySignals = {});
+
+    /// @brief Wait on `type`'s timeline reaching `value`, for another submission
+    SemaphoreWait after(QueueType type, uint64_t value, VkPipelineStageFlags stages) const;
+
+    /// @brief Blocks until every listed queue reached its value, in a single driver call
+    void wait(std::initializer_list<std::pair<QueueType, uint64_t>> values) const;
+    /// @brief Blocks until everything submitted so far is done, on every queue
+    void waitIdle() const;
+
+    // Getters
+    inline Timeline &timeline(QueueType type) { return _timelines[static_cast<size_t>(type)]; }
+    inline const Timeline &timeline(QueueType type) const { return _timelines[static_cast<size_t>(type)]; }
+    inline bool reached(QueueType type, uint64_t value) const { return timeline(type).reached(value); }
+};
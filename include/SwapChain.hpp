@@ -4,6 +4,8 @@
 
 #include "global.hpp"
 
+#include <glm/glm.hpp>
+
 class Window;
 class Device;
 
@@ -22,7 +24,6 @@ private:
 
     SwapChainSupportDetails _supportDetails;
     VkSwapchainKHR _swapChain;
-    VkSwapchainKHR _oldSwapChain;
 
     // Swap chain image handles
     std::vector<VkImage> _images;
@@ -31,7 +32,15 @@ private:
     VkFormat _imageFormat;
     VkExtent2D _extent;
 
-    void createSwapChain();
+    /// @brief Present mode asked for, and the one actually in use
+    VkPresentModeKHR _requestedPresentMode;
+    VkPresentModeKHR _presentMode;
+    /// @brief Usage asked for on top of COLOR_ATTACHMENT, e.g TRANSFER_SRC to read the images back
+    VkImageUsageFlags _extraUsage;
+    /// @brief Size of the window's framebuffer, for surfaces letting the swapchain pick its extent
+    glm::ivec2 _framebufferSize;
+
+    void createSwapChain(VkSwapchainKHR oldSwapChain);
     void createImageViews();
 
     void destroyImageViews();
@@ -39,14 +48,22 @@ private:
     static VkSurfaceFormatKHR ChooseSwapSurfaceFormat(
         const std::vector<VkSurfaceFormatKHR> &availableFormats);
     static VkPresentModeKHR ChooseSwapPresentMode(
-        const std::vector<VkPresentModeKHR> &availablePresentModes);
+        const std::vector<VkPresentModeKHR> &availablePresentModes, VkPresentModeKHR requested);
 
 public:
-    explicit SwapChain(const Device &device, const Window &window);
+    /// @param extraUsage Image usage on top of COLOR_ATTACHMENT, throws if the surface doesn't support it
+    explicit SwapChain(const Device &device, const Window &window, VkImageUsageFlags extraUsage = 0);
     ~SwapChain();
 
+    /// @brief Creates a new swapchain from the current one. The old one is destroyed once the frames in flight are done with it
     void recreate();
-    void cleanupOld();
+
+    /// @brief Present mode used from the next recreate() on, FIFO if the surface doesn't support it.
+    /// IMMEDIATE and FIFO_RELAXED favor latency and may tear, MAILBOX doesn't tear but keeps the GPU busy, FIFO draws the least power
+    inline void setPresentMode(VkPresentModeKHR presentMode) { _requestedPresentMode = presentMode; }
+    /// @brief Framebuffer size used from the next recreate() on. Passed in rather than asked to the window :
+    /// GLFW only answers on the main thread, and the swapchain is recreated on the render thread
+    inline void setFramebufferSize(const glm::ivec2 &size) { _framebufferSize = size; }
 
     // Getters
     inline const VkSwapchainKHR &handle() const { return _swapChain; }
@@ -56,11 +73,17 @@ public:
     inline size_t numImageViews() const { return _imageViews.size(); }
     inline const SwapChainSupportDetails &supportDetails() const { return _supportDetails; }
     inline VkImageView imageView(uint32_t index) const { return _imageViews[index]; }
+    inline VkImage image(uint32_t index) const { return _images[index]; }
+    inline VkPresentModeKHR requestedPresentMode() const { return _requestedPresentMode; }
+    inline VkPresentModeKHR presentMode() const { return _presentMode; }
 
     static SwapChainSupportDetails
     QuerySwapChainSupport(const VkPhysicalDevice &device,
                           const VkSurfaceKHR &surface);
+    static const char *PresentModeName(VkPresentModeKHR presentMode);
+
+    /// @brief The surface's own extent, or `framebufferSize` clamped to what it supports when it lets the swapchain decide (Wayland)
     static VkExtent2D
     ChooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities,
-                     const Window &window);
+                     const glm::ivec2 &framebufferSize);
 };
\ No newline at end of file
@@ -4,26 +4,25 @@
 // Forward declaration
 class Device;
 
+/// @brief Binary semaphores tied to the swapchain images, as presentation can't wait on a timeline.
+/// Per-frame objects live in FrameContext, and CPU/GPU pacing goes through the Scheduler timelines
 class Sync
 {
 private:
     const Device &_device;
 
-    uint32_t _numImages, _maxFramesInFlight;
-
-    std::vector<VkSemaphore> _imageAvailable;
+    /// @brief Signaled by the frame rendering to an image, waited on by its presentation
     std::vector<VkSemaphore> _renderFinished;
-    std::vector<VkFence> _inFlightFences;
-    std::vector<VkFence> _imagesInFlight;
+
+    void createSemaphores(uint32_t numImages);
 
 public:
-    Sync(const Device &device, uint32_t numImages,
-                uint32_t maxFramesInFlight);
+    Sync(const Device &device, uint32_t numImages);
     ~Sync();
 
+    /// @brief Matches a new swapchain. The old semaphores may still be waited on by presentation, so their destruction is deferred
+    void recreate(uint32_t numImages);
+
     // Getters
-    inline VkSemaphore &imageAvailable(uint32_t index) { return _imageAvailable[index]; }
-    inline VkSemaphore &renderFinished(uint32_t index) { return _renderFinished[index]; }
-    inline VkFence &inFlightFence(uint32_t index) { return _inFlightFences[index]; }
-    inline VkFence &imageInFlight(uint32_t index) { return _imagesInFlight[index]; }
-};
\ No newline at end of file
+    inline VkSemaphore &renderFinished(uint32_t image) { return _renderFinished[image]; }
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include "global.hpp"
+
+// Forward declaration
+class Device;
+
+/// @brief Timeline semaphore : a 64-bit counter set by the GPU as submissions complete.
+/// Each submission signals the next value, so "is submission N done" is a single counter read.
+class Timeline
+{
+private:
+    const Device &_device;
+
+    VkSemaphore _semaphore;
+    /// @brief Last value handed out to a submission
+    uint64_t _pending;
+    /// @brief Last value read back from the GPU, saves a driver call when already reached
+    mutable uint64_t _completed;
+
+public:
+    Timeline(const Device &device);
+    ~Timeline();
+
+    Timeline(const Timeline &) = delete;
+    Timeline &operator=(const Timeline &) = delete;
+
+    /// @brief Reserves the value the next submission will signal
+    uint64_t next();
+
+    /// @brief Value reached by the GPU so far
+    uint64_t completed() const;
+    inline bool reached(uint64_t value) const { return value <= _completed || value <= completed(); }
+
+    /// @brief Blocks until the GPU reaches `value`
+    void wait(uint64_t value) const;
+
+    // Getters
+    inline const VkSemaphore &handle() const { return _semaphore; }
+    inline uint64_t pending() const { return _pending; }
+};
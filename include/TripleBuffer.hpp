@@ -0,0 +1,85 @@
+#pragma once
+#include "global.hpp"
+
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+/// @brief Hands values from one producer thread to one consumer thread without either of them waiting on the other.
+/// The producer always has a slot to write to, the consumer always reads the latest published one :
+/// a value published while the previous one wasn't consumed yet replaces it. A producer that shouldn't outrun the
+/// consumer can still wait for it with waitConsumed().
+/// Slots are reused as they are, so their allocations carry over from one round to the next
+template <typename T>
+class TripleBuffer
+{
+private:
+    std::array<T, 3> _slots;
+
+    // Indices of the slots, only swapped under the mutex
+    uint32_t _write = 0;
+    uint32_t _ready = 1;
+    uint32_t _read = 2;
+    /// @brief Whether `_ready` holds a value the consumer hasn't taken yet
+    bool _fresh = false;
+    bool _closed = false;
+
+    std::mutex _mutex;
+    std::condition_variable _published;
+    std::condition_variable _consumed;
+
+public:
+    /// @brief Producer : slot to fill before publish(), never read by the consumer meanwhile
+    inline T &back() { return _slots[_write]; }
+
+    /// @brief Producer : makes the back slot the latest value
+    void publish()
+    {
+        {
+            std::lock_guard lock(_mutex);
+            std::swap(_write, _ready);
+            _fresh = true;
+        }
+        _published.notify_one();
+    }
+
+    /// @brief Producer : blocks until the consumer took the last value published, or the buffer is closed
+    void waitConsumed()
+    {
+        std::unique_lock lock(_mutex);
+        _consumed.wait(lock, [this]
+                       { return !_fresh || _closed; });
+    }
+
+    /// @brief Consumer : latest published value, waiting if it was already taken.
+    /// Stays valid until the next acquire(). nullptr once closed
+    T *acquire()
+    {
+        T *value;
+        {
+            std::unique_lock lock(_mutex);
+            _published.wait(lock, [this]
+                            { return _fresh || _closed; });
+            if (_closed)
+                return nullptr;
+
+            std::swap(_read, _ready);
+            _fresh = false;
+            value = &_slots[_read];
+        }
+        _consumed.notify_one();
+        return value;
+    }
+
+    /// @brief Wakes both sides up for good
+    void close()
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _closed = true;
+        }
+        _published.notify_all();
+        _consumed.notify_all();
+    }
+};
@@ -19,12 +19,18 @@ private:
     GLFWwindow *_window;
     /// @brief Actual surface to draw onto
     VkSurfaceKHR _surface;
+    /// @brief No display : no GLFW window, and a VK_EXT_headless_surface to render to
+    bool _headless;
+    /// @brief Closing asked for by the application, the only way out of a headless main loop
+    bool _closeRequested;
     
     /// @brief Has the window been resized this frame ?
     bool _resized;
     
     /// @brief Callback for the main loop, draws each frame
     std::function<void(bool &)> _drawFrameFunc;
+    /// @brief Inside the draw callback, which the refresh callback must not call again
+    bool _drawing;
     /// @brief Actual Vulkan instance used for the surface
     VkInstance _instance;
     /// @brief Are the validation layers enabled ?
@@ -35,16 +41,23 @@ public:
     static const std::vector<const char *> ValidationLayers;
     /// @brief Global device extensions
     static const std::vector<const char *> DeviceExtensions;
+    /// @brief Vulkan version the instance is created with
+    static const uint32_t ApiVersion;
 
-    Window(const std::string appName, const glm::ivec2 size, const char *engineName, const bool enableLayers);
+    /// @param headless Renders without a display, nor GLFW : the surface never resizes and has no window to close
+    Window(const std::string appName, const glm::ivec2 size, const char *engineName, const bool enableLayers, const bool headless = false);
     ~Window();
 
-    /// @brief Main loop of the window
-    void mainLoop(const Device& device);
+    /// @brief Main loop of the window, until it is closed. Waiting for the GPU is left to the caller
+    void mainLoop();
 
     /// @brief Fetch required extensions for Vulkan
     std::vector<const char *> getRequiredExtensions();
 
+    /// @brief Leaves the main loop after the current frame
+    inline void close() { _closeRequested = true; }
+    inline bool shouldClose() const { return _closeRequested || (_window && glfwWindowShouldClose(_window)); }
+
     /// @brief Changes the "draw frame" function, which is called each frame by the application
     /// @param func
     inline void setDrawFrameFunc(const std::function<void(bool &)> &func)
@@ -54,7 +67,10 @@ public:
 
     inline void framebufferSize(glm::ivec2 &size) const
     {
-        glfwGetFramebufferSize(_window, &size[0], &size[1]);
+        if (_headless)
+            size = _size;
+        else
+            glfwGetFramebufferSize(_window, &size[0], &size[1]);
     }
 
     // Getters
@@ -63,14 +79,21 @@ public:
     inline const VkInstance &instance() const { return _instance; }
     inline const VkSurfaceKHR &surface() const { return _surface; }
     inline bool enabledValidationLayers() const { return _enableValidationLayers; }
+    inline bool headless() const { return _headless; }
 
     /// @brief Handle frame buffer resize (window resize)
     /// @param window
     /// @param width
     /// @param height
     static void FramebufferResizeCallback(GLFWwindow *window, int width, int height);
+    /// @brief Keeps drawing while the event loop is stuck in a live resize (modal on some platforms),
+    /// instead of the window showing stretched frames until the mouse is released
+    /// @param window
+    static void WindowRefreshCallback(GLFWwindow *window);
 
     /// @brief Checks if validation layers are all supported
     /// @return
     static bool CheckValidationLayerSupport();
+    /// @brief Checks if the instance can create headless surfaces
+    static bool CheckHeadlessSurfaceSupport();
 };
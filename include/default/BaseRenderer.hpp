@@ -3,25 +3,44 @@
 
 #include <Renderer.hpp>
 
-#include <geometry/Vertex.hpp>
+#include <geometry/Mesh.hpp>
+#include <geometry/MeshFile.hpp>
+#include <memory/Allocator.hpp>
+
+#include <array>
 
 class BaseRenderer : public Renderer
 {
 private:
-    void createCommandBuffers() override;
-
-    VkBuffer _vertexBuffer;
-    VkDeviceMemory _vertexBufferMemory;
+    /// @brief One buffer per stream of `Vertex::Layout`
+    std::array<Buffer, Vertex::Layout::BindingCount> _vertexBuffers;
+    Buffer _indexBuffer;
+    uint32_t _indexCount;
+    VkIndexType _indexType;
 
     void createVertexBuffer();
-
-    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+    void createIndexBuffer();
+    /// @brief Copies the cooked sections straight from the file mapping to the GPU
+    void uploadMeshFile(const MeshFile &meshFile);
 
 public:
-    std::vector<Vertex> vertices;
-
-    BaseRenderer(const Device &device, const RenderPass &renderPass, const SwapChain &swapChain, const GraphicsPipeline &graphicsPipeline, const VkCommandPoolCreateFlags &flags, std::vector<Vertex> vertices);
+    // Edited on the main thread only, copied into each render packet by captureState()
+
+    /// @brief CPU copy of the geometry, empty when loaded from a cooked file
+    Mesh mesh;
+    /// @brief If set, `mesh.vertices` is streamed through the frame context's ring every frame instead of using the static buffer,
+    /// so edits show up on the next frame. Needs the CPU copy
+    bool dynamicVertices = false;
+    /// @brief Copies of the mesh drawn by the one draw call. Call markDirty() after changing it
+    uint32_t instanceCount = 1;
+
+    BaseRenderer(const Device &device, const RenderPass &renderPass, const SwapChain &swapChain, const GraphicsPipeline &graphicsPipeline, Mesh mesh);
+    /// @brief Draws LOD 0 of a cooked mesh. The file can be closed once constructed
+    BaseRenderer(const Device &device, const RenderPass &renderPass, const SwapChain &swapChain, const GraphicsPipeline &graphicsPipeline, const MeshFile &meshFile);
     ~BaseRenderer();
 
-    void recordCommandBuffer(uint32_t index) override;
+    void captureState(DrawState &state) const override;
+    void record(VkCommandBuffer commandBuffer, FrameContext &frame, const DrawState &state) override;
+    /// @brief Streamed vertices live in the frame ring, at a different place every frame
+    bool cacheable(const DrawState &state) const override { return state.streamedVertices.empty(); }
 };
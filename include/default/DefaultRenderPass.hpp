@@ -3,11 +3,17 @@
 
 #include <RenderPass.hpp>
 
+/// @brief Scene, then overlays (UI) drawn on top of it, in a single pass over the swapchain image :
+/// it is loaded (cleared) and stored only once per frame, and stays in tile memory between the two subpasses.
+/// With dynamic rendering, both subpasses are a single rendering
 class DefaultRenderPass : public RenderPass
 {
 private:
     void createRenderPass() override;
 
 public:
-    DefaultRenderPass(const Device &device, const SwapChain &swapChain);
+    static const uint32_t SceneSubpass;
+    static const uint32_t OverlaySubpass;
+
+    DefaultRenderPass(const Device &device, const SwapChain &swapChain, bool dynamic = false);
 };
\ No newline at end of file
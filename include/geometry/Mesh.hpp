@@ -0,0 +1,40 @@
+#pragma once
+#include "global.hpp"
+
+#include <geometry/Vertex.hpp>
+
+#include <vector>
+#include <unordered_map>
+
+/// @brief Indexed triangle list
+struct Mesh
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+
+    /// @brief 16-bit indices whenever every vertex can be addressed with them, 32-bit otherwise
+    VkIndexType indexType() const;
+    /// @brief Size of a single index, in bytes
+    size_t indexSize() const;
+    /// @brief Indices converted to `indexType()`, ready to be uploaded
+    std::vector<uint8_t> packedIndices() const;
+};
+
+/// @brief Builds an indexed mesh out of triangles, merging identical vertices
+class MeshBuilder
+{
+private:
+    Mesh _mesh;
+    std::unordered_map<Vertex, uint32_t> _lookup;
+
+public:
+    /// @brief Adds a vertex, or finds the identical one already added
+    /// @return Index of the vertex
+    uint32_t addVertex(const Vertex &vertex);
+    void addTriangle(const Vertex &a, const Vertex &b, const Vertex &c);
+    /// @brief Adds a non-indexed triangle list (3 vertices per triangle)
+    void addTriangles(const std::vector<Vertex> &triangles);
+
+    /// @brief Gives the mesh back, optionally running it through the MeshOptimizer passes
+    Mesh build(bool optimize = true);
+};
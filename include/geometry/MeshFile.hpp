@@ -0,0 +1,134 @@
+#pragma once
+#include "global.hpp"
+
+#include <geometry/Mesh.hpp>
+
+#include <string>
+#include <vector>
+
+/// @brief Read-only view of a whole file through mmap. Pages are only read from disk when touched
+class MappedFile
+{
+private:
+    const void *_data;
+    size_t _size;
+
+public:
+    MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /// @brief Hints the kernel that the range is about to be read front to back, so it reads ahead aggressively
+    void willRead(size_t offset, size_t size) const;
+
+    inline const void *data() const { return _data; }
+    inline size_t size() const { return _size; }
+};
+
+/// @brief Axis aligned box and bounding sphere, as stored in cooked meshes
+struct MeshBounds
+{
+    float min[3];
+    float radius;
+    float max[3];
+    float center[3];
+};
+
+/// @brief Level of detail : a range of the shared index section
+struct MeshLod
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    /// @brief Geometric error compared to LOD 0, in mesh units
+    float error;
+    uint32_t boundsIndex;
+};
+
+/// @brief Cooked mesh file (.vkbm) : vertices already packed in the `Vertex::Layout` streams and optimised
+/// indices in their final width, each section aligned so it can be copied straight from the mapping.
+///
+/// Layout : header, section table, then the sections (vertex streams, indices, bounds table, LOD table)
+class MeshFile
+{
+public:
+    struct Section
+    {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        /// @brief VkIndexType of the index section
+        uint32_t indexType;
+        uint32_t streamCount;
+        uint32_t boundsCount;
+        uint32_t lodCount;
+        /// @brief LayoutHash() when cooked : the streams are packed for that layout only
+        uint64_t layoutHash;
+        /// @brief Hash of whatever the mesh was cooked from, as given to Write(). Tells when to cook it again
+        uint64_t sourceHash;
+    };
+
+    static const char Magic[4];
+    static const uint32_t Version;
+    /// @brief Alignment of every section inside the file, enough for any attribute format and for SIMD copies
+    static const uint64_t SectionAlignment;
+
+private:
+    MappedFile _file;
+
+    const Header *_header;
+    const Section *_streams;
+    Section _indices;
+    Section _bounds;
+    Section _lods;
+
+    inline const char *at(const Section &section) const { return static_cast<const char *>(_file.data()) + section.offset; }
+    /// @brief Throws if a section doesn't fit in the file or breaks the alignment rule
+    void checkSection(const Section &section, uint64_t expectedSize, const char *name) const;
+
+public:
+    /// @brief Maps a cooked mesh, checking it matches the current vertex layout
+    MeshFile(const std::string &path);
+
+    /// @brief Cooks a mesh. LOD 0 is `mesh.indices`, written as is, `lods` are coarser index lists over the same vertices,
+    /// optimised for the vertex cache
+    /// @param sourceHash Hash of the source the mesh was built from (see Hash()), checked by UpToDate()
+    /// @param lodErrors Geometric error of each of `lods`, 0 when missing
+    static void Write(const std::string &path, const Mesh &mesh, uint64_t sourceHash, const std::vector<std::vector<uint32_t>> &lods = {},
+                      const std::vector<float> &lodErrors = {});
+    /// @brief Whether `path` is a mesh cooked from a source hashing to `sourceHash`, for the current version and vertex layout.
+    /// Only reads the header : false rather than a throw if the file is missing or isn't a cooked mesh
+    static bool UpToDate(const std::string &path, uint64_t sourceHash);
+
+    /// @brief FNV-1a over `size` bytes, chained through `hash`
+    static uint64_t Hash(const void *data, size_t size, uint64_t hash = 14695981039346656037ull);
+    /// @brief Hash of the bindings and attributes of `Vertex::Layout`
+    static uint64_t LayoutHash();
+
+    /// @brief Starts reading every section from disk in the background
+    void prefetch() const;
+
+    // Getters, pointing straight into the mapping
+    inline uint32_t vertexCount() const { return _header->vertexCount; }
+    inline uint32_t indexCount() const { return _header->indexCount; }
+    inline VkIndexType indexType() const { return static_cast<VkIndexType>(_header->indexType); }
+    inline uint32_t streamCount() const { return _header->streamCount; }
+
+    inline const void *streamData(uint32_t stream) const { return at(_streams[stream]); }
+    inline VkDeviceSize streamSize(uint32_t stream) const { return _streams[stream].size; }
+    inline const void *indexData() const { return at(_indices); }
+    inline VkDeviceSize indexSize() const { return _indices.size; }
+
+    inline uint32_t boundsCount() const { return _header->boundsCount; }
+    inline const MeshBounds &bounds(uint32_t index) const { return reinterpret_cast<const MeshBounds *>(at(_bounds))[index]; }
+    inline uint32_t lodCount() const { return _header->lodCount; }
+    inline const MeshLod &lod(uint32_t index) const { return reinterpret_cast<const MeshLod *>(at(_lods))[index]; }
+};
@@ -0,0 +1,36 @@
+#pragma once
+#include "global.hpp"
+
+#include <vector>
+
+struct Mesh;
+
+/// @brief Index and vertex reordering passes, cutting vertex shader invocations and memory traffic.
+/// Passes work on raw vertex data (pointer + stride) so they apply to any vertex layout.
+class MeshOptimizer
+{
+public:
+    /// @brief Size of the simulated post-transform cache, for the scoring and the statistics
+    static const uint32_t CacheSize;
+
+    /// @brief Reorders triangles to maximise post-transform cache hits (Forsyth's linear-speed algorithm)
+    static void OptimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount);
+
+    /// @brief Reorders groups of triangles so that outward facing ones are drawn first, reducing overdraw.
+    /// Groups are cut where the cache is cold anyway, so the vertex cache efficiency is mostly kept.
+    /// @param positions Pointer to the first vertex position (3 floats)
+    /// @param stride Distance in bytes between two vertex positions
+    /// @param threshold Maximum cache miss ratio degradation allowed, the original order is kept above it
+    static void OptimizeOverdraw(std::vector<uint32_t> &indices, const float *positions, size_t vertexCount, size_t stride, float threshold = 1.05f);
+
+    /// @brief Reorders vertices in order of first use, so vertex fetches walk memory linearly.
+    /// Unreferenced vertices are dropped.
+    /// @return New vertex count
+    static size_t OptimizeVertexFetch(void *vertices, size_t vertexCount, size_t stride, std::vector<uint32_t> &indices);
+
+    /// @brief Average number of vertex shader invocations per triangle with a FIFO cache of `cacheSize`
+    static float AverageCacheMissRatio(const std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize = 16);
+
+    /// @brief Runs every pass on a mesh, in the order they should be applied
+    static void Optimize(Mesh &mesh);
+};
@@ -2,14 +2,48 @@
 #include "global.hpp"
 #include <glm/glm.hpp>
 
+#include <geometry/VertexLayout.hpp>
+
 #include <array>
+#include <cstring>
+#include <functional>
+#include <vector>
 
 struct Vertex
 {
     glm::vec3 pos;
     glm::vec3 color;
 
-    static VkVertexInputBindingDescription getBindingDescription();
+    /// @brief Positions alone, at full precision : enough for depth-only passes
+    using PositionStream = VertexStream<Attribute<0, VertexFormat::Float3>>;
+    /// @brief Everything else, packed : colors only need 8 bits per channel
+    using ShadingStream = VertexStream<Attribute<1, VertexFormat::Unorm8x4>>;
+
+    /// @brief GPU layout, one vertex buffer per stream
+    using Layout = VertexLayout<PositionStream, ShadingStream>;
+    using DepthLayout = VertexLayout<PositionStream>;
+
+    /// @brief Bytes per vertex of the `stream`th stream of `Layout`
+    static uint32_t StreamStride(uint32_t stream);
+    /// @brief Converts vertices to the GPU format of the `stream`th stream of `Layout`
+    static std::vector<uint8_t> PackStream(const std::vector<Vertex> &vertices, uint32_t stream);
+    /// @brief Same, written straight to `dst` (e.g mapped memory), which must hold `vertices.size() * StreamStride(stream)` bytes
+    static void PackStream(const std::vector<Vertex> &vertices, uint32_t stream, void *dst);
 
-    static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions();
+    /// @brief Bitwise comparison, used to find duplicated vertices
+    inline bool operator==(const Vertex &other) const { return memcmp(this, &other, sizeof(Vertex)) == 0; }
+};
+
+template <>
+struct std::hash<Vertex>
+{
+    size_t operator()(const Vertex &vertex) const noexcept
+    {
+        // FNV-1a over the raw bytes, consistent with the bitwise operator==
+        const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&vertex);
+        size_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < sizeof(Vertex); i++)
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        return hash;
+    }
 };
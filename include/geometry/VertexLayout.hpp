@@ -0,0 +1,162 @@
+#pragma once
+#include "global.hpp"
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+/// @brief Attribute formats : the Vulkan format, and the C++ type holding one packed value
+namespace VertexFormat
+{
+    template <VkFormat F, typename T>
+    struct Format
+    {
+        static constexpr VkFormat format = F;
+        using type = T;
+        static constexpr uint32_t size = sizeof(T);
+
+        // Keeps every attribute offset 4-byte aligned, as some drivers require
+        static_assert(sizeof(T) % 4 == 0, "Vertex attribute formats must be a multiple of 4 bytes");
+    };
+
+    using Float1 = Format<VK_FORMAT_R32_SFLOAT, float>;
+    using Float2 = Format<VK_FORMAT_R32G32_SFLOAT, glm::vec2>;
+    using Float3 = Format<VK_FORMAT_R32G32B32_SFLOAT, glm::vec3>;
+    using Float4 = Format<VK_FORMAT_R32G32B32A32_SFLOAT, glm::vec4>;
+
+    using Half2 = Format<VK_FORMAT_R16G16_SFLOAT, std::array<uint16_t, 2>>;
+    using Half4 = Format<VK_FORMAT_R16G16B16A16_SFLOAT, std::array<uint16_t, 4>>;
+
+    using Snorm16x2 = Format<VK_FORMAT_R16G16_SNORM, std::array<int16_t, 2>>;
+    using Snorm16x4 = Format<VK_FORMAT_R16G16B16A16_SNORM, std::array<int16_t, 4>>;
+    using Unorm16x2 = Format<VK_FORMAT_R16G16_UNORM, std::array<uint16_t, 2>>;
+
+    using Snorm8x4 = Format<VK_FORMAT_R8G8B8A8_SNORM, uint32_t>;
+    using Unorm8x4 = Format<VK_FORMAT_R8G8B8A8_UNORM, uint32_t>;
+    /// @brief 10 bits per component, the only 10:10:10:2 format every GPU can read as a vertex attribute
+    using Unorm10x3 = Format<VK_FORMAT_A2B10G10R10_UNORM_PACK32, uint32_t>;
+}
+
+/// @brief Shader input `location`, read with the given `VertexFormat`
+template <uint32_t Location, typename F>
+struct Attribute
+{
+    static constexpr uint32_t location = Location;
+    using Format = F;
+};
+
+/// @brief One vertex buffer binding : attributes are packed one after the other, in declaration order
+template <VkVertexInputRate Rate, typename... Attributes>
+struct BasicVertexStream
+{
+    static constexpr VkVertexInputRate InputRate = Rate;
+    static constexpr uint32_t AttributeCount = sizeof...(Attributes);
+    static constexpr uint32_t Stride = (0 + ... + Attributes::Format::size);
+
+    static constexpr std::array<uint32_t, AttributeCount> Offsets = []
+    {
+        std::array<uint32_t, AttributeCount> offsets{};
+        uint32_t offset = 0, i = 0;
+        ((offsets[i++] = offset, offset += Attributes::Format::size), ...);
+        return offsets;
+    }();
+
+    template <size_t I>
+    using AttributeAt = std::tuple_element_t<I, std::tuple<Attributes...>>;
+
+    static constexpr std::array<VkVertexInputAttributeDescription, AttributeCount> AttributeDescriptions(uint32_t binding)
+    {
+        std::array<VkVertexInputAttributeDescription, AttributeCount> descriptions{};
+        uint32_t i = 0;
+        ((descriptions[i] = {Attributes::location, binding, Attributes::Format::format, Offsets[i]}, i++), ...);
+        return descriptions;
+    }
+
+    /// @brief Writes the `I`th attribute of the vertex starting at `vertex`
+    template <size_t I>
+    static void Write(void *vertex, const typename AttributeAt<I>::Format::type &value)
+    {
+        memcpy(static_cast<char *>(vertex) + Offsets[I], &value, sizeof(value));
+    }
+};
+
+template <typename... Attributes>
+using VertexStream = BasicVertexStream<VK_VERTEX_INPUT_RATE_VERTEX, Attributes...>;
+template <typename... Attributes>
+using InstanceStream = BasicVertexStream<VK_VERTEX_INPUT_RATE_INSTANCE, Attributes...>;
+
+/// @brief Runtime copy of a layout's descriptions, for code that isn't templated on the layout
+struct VertexInputDescription
+{
+    std::vector<VkVertexInputBindingDescription> bindings;
+    std::vector<VkVertexInputAttributeDescription> attributes;
+};
+
+/// @brief Full vertex input of a pipeline : stream `i` is bound to binding `i`.
+/// A pass that only needs some attributes (like a depth prepass) uses a layout made of a subset of the streams.
+template <typename... Streams>
+struct VertexLayout
+{
+    static constexpr uint32_t BindingCount = sizeof...(Streams);
+    static constexpr uint32_t AttributeCount = (0 + ... + Streams::AttributeCount);
+
+    template <size_t I>
+    using Stream = std::tuple_element_t<I, std::tuple<Streams...>>;
+
+    static constexpr std::array<VkVertexInputBindingDescription, BindingCount> Bindings = []
+    {
+        std::array<VkVertexInputBindingDescription, BindingCount> bindings{};
+        uint32_t binding = 0;
+        ((bindings[binding] = {binding, Streams::Stride, Streams::InputRate}, binding++), ...);
+        return bindings;
+    }();
+
+    static constexpr std::array<VkVertexInputAttributeDescription, AttributeCount> Attributes = []
+    {
+        std::array<VkVertexInputAttributeDescription, AttributeCount> attributes{};
+        uint32_t binding = 0, i = 0;
+        (
+            [&]
+            {
+                for (const auto &attribute : Streams::AttributeDescriptions(binding))
+                    attributes[i++] = attribute;
+                binding++;
+            }(),
+            ...);
+        return attributes;
+    }();
+
+    static_assert([]
+                  {
+                      for (uint32_t a = 0; a < AttributeCount; a++)
+                          for (uint32_t b = a + 1; b < AttributeCount; b++)
+                              if (Attributes[a].location == Attributes[b].location)
+                                  return false;
+                      return true; }(),
+                  "Two vertex attributes share the same location");
+
+    static VertexInputDescription Description()
+    {
+        return {{Bindings.begin(), Bindings.end()}, {Attributes.begin(), Attributes.end()}};
+    }
+};
+
+/// @brief Conversions from full precision values to the packed attribute formats
+class VertexPacking
+{
+public:
+    /// @brief IEEE half, round to nearest even
+    static uint16_t Half(float value);
+    static std::array<uint16_t, 2> Half2(glm::vec2 value);
+    static std::array<uint16_t, 4> Half4(glm::vec4 value);
+
+    static std::array<int16_t, 2> Snorm16x2(glm::vec2 value);
+    static std::array<int16_t, 4> Snorm16x4(glm::vec4 value);
+
+    static uint32_t Snorm8x4(glm::vec4 value);
+    static uint32_t Unorm8x4(glm::vec4 value);
+    /// @brief Signed values (e.g normals) are remapped from [-1, 1] to [0, 1], to be undone in the shader
+    static uint32_t Unorm10x3(glm::vec3 value, bool isSigned = true);
+};
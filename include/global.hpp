@@ -7,4 +7,5 @@
 #include <stdexcept>
 #include <cstdlib>
 
-#define SHADERS_PATH "../assets/shaders/"
\ No newline at end of file
+#define SHADERS_PATH "../assets/shaders/"
+#define MESHES_PATH "../assets/meshes/"
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+#include "global.hpp"
+
+#include <memory/MemoryBlock.hpp>
+#include <memory/MemoryTypes.hpp>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+// Forward declaration
+class Device;
+
+/// @brief A sub-range of a MemoryBlock, owned by a single buffer or image
+struct Allocation
+{
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    uint32_t memoryType = 0;
+    /// @brief Host pointer to the start of the allocation, nullptr if not host visible
+    void *mapped = nullptr;
+
+    MemoryBlock *block = nullptr;
+    uint64_t pool = 0;
+};
+
+struct Buffer
+{
+    VkBuffer handle = VK_NULL_HANDLE;
+    VkDeviceSize size = 0;
+    Allocation allocation;
+};
+
+struct Image
+{
+    VkImage handle = VK_NULL_HANDLE;
+    Allocation allocation;
+};
+
+/// @brief Usage of a single memory heap, as seen by the allocator. A snapshot : the allocator keeps updating its own
+struct HeapStats
+{
+    /// @brief Bytes reserved from the driver through vkAllocateMemory
+    VkDeviceSize blockBytes = 0;
+    /// @brief Bytes actually handed out to buffers and images
+    VkDeviceSize allocatedBytes = 0;
+    uint32_t blockCount = 0;
+    uint32_t allocationCount = 0;
+};
+
+/// @brief Device-wide GPU memory allocator.
+/// Buffers and images are carved out of large per-memory-type blocks, so the
+/// number of vkAllocateMemory calls stays tiny whatever the number of resources.
+class Allocator
+{
+private:
+    struct Pool
+    {
+        std::vector<std::unique_ptr<MemoryBlock>> blocks;
+    };
+
+    /// @brief HeapStats as the allocator updates them. Atomic since other threads read them while resources come and go
+    struct HeapCounters
+    {
+        std::atomic<VkDeviceSize> blockBytes{0};
+        std::atomic<VkDeviceSize> allocatedBytes{0};
+        std::atomic<uint32_t> blockCount{0};
+        std::atomic<uint32_t> allocationCount{0};
+    };
+
+    const Device &_device;
+    const MemoryTypeTable &_memoryTypes;
+
+    VkDeviceSize _bufferImageGranularity;
+    uint32_t _maxAllocationCount;
+    uint32_t _allocationCount;
+
+    /// @brief Pools indexed by memory type, strategy and tiling (see PoolKey)
+    std::map<uint64_t, Pool> _pools;
+    /// @brief heapCount() long
+    std::unique_ptr<HeapCounters[]> _heapStats;
+
+    /// @brief Size of the blocks created for a given memory type
+    VkDeviceSize blockSize(uint32_t memoryType) const;
+    uint64_t poolKey(uint32_t memoryType, AllocationStrategy strategy, bool optimalTiling) const;
+    /// @brief Range covering [offset, offset + size) of `allocation`, widened to nonCoherentAtomSize
+    VkMappedMemoryRange mappedRange(const Allocation &allocation, VkDeviceSize offset, VkDeviceSize size) const;
+
+    MemoryBlock *createBlock(uint32_t memoryType, VkDeviceSize size, AllocationStrategy strategy);
+    void destroyBlock(MemoryBlock *block);
+
+    Allocation allocateFromType(const VkMemoryRequirements &requirements, uint32_t memoryType, AllocationStrategy strategy, bool optimalTiling);
+    VkBuffer createBufferHandle(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryRequirements &requirements);
+    Buffer bindBuffer(VkBuffer handle, VkDeviceSize size, const VkMemoryRequirements &requirements, uint32_t memoryType, AllocationStrategy strategy);
+    VkImage createImageHandle(const VkImageCreateInfo &createInfo, VkMemoryRequirements &requirements);
+    Image bindImage(VkImage handle, const VkMemoryRequirements &requirements, uint32_t memoryType, AllocationStrategy strategy, bool optimalTiling);
+
+public:
+    /// @brief Default size of a block, big heaps only
+    static const VkDeviceSize DefaultBlockSize;
+
+    Allocator(const Device &device);
+    ~Allocator();
+
+    /// @brief Reserves memory matching the given requirements
+    /// @param optimalTiling Whether the resource is an optimally tiled image, used to honour bufferImageGranularity
+    Allocation allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties,
+                        AllocationStrategy strategy = AllocationStrategy::FreeList, bool optimalTiling = false);
+    /// @brief Same, picking the memory type from the device's preferred types for `usage`
+    Allocation allocate(const VkMemoryRequirements &requirements, MemoryUsage usage,
+                        AllocationStrategy strategy = AllocationStrategy::FreeList, bool optimalTiling = false);
+    void free(Allocation &allocation);
+    /// @brief Makes host writes to a mapped allocation visible to the device. Nothing to do on coherent memory
+    void flush(const Allocation &allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const;
+    /// @brief Makes device writes to a mapped allocation visible to the host. Nothing to do on coherent memory
+    void invalidate(const Allocation &allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE) const;
+
+    /// @brief Creates a buffer and binds it to freshly allocated memory. Host visible memory comes persistently mapped.
+    Buffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+                        AllocationStrategy strategy = AllocationStrategy::FreeList);
+    Buffer createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, MemoryUsage memoryUsage,
+                        AllocationStrategy strategy = AllocationStrategy::FreeList);
+    void destroyBuffer(Buffer &buffer);
+
+    /// @brief Creates an image and binds it to freshly allocated memory
+    Image createImage(const VkImageCreateInfo &createInfo, VkMemoryPropertyFlags properties,
+                      AllocationStrategy strategy = AllocationStrategy::FreeList);
+    Image createImage(const VkImageCreateInfo &createInfo, MemoryUsage memoryUsage,
+                      AllocationStrategy strategy = AllocationStrategy::FreeList);
+    void destroyImage(Image &image);
+
+    /// @brief Usage of heap `heap`, safe to call from any thread
+    HeapStats heapStats(uint32_t heap) const;
+
+    // Getters
+    inline const VkPhysicalDeviceMemoryProperties &memoryProperties() const { return _memoryTypes.properties(); }
+    inline uint32_t heapCount() const { return _memoryTypes.properties().memoryHeapCount; }
+    inline uint32_t deviceAllocationCount() const { return _allocationCount; }
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include "global.hpp"
+
+#include <memory/Allocator.hpp>
+
+#include <mutex>
+
+// Forward declaration
+class Device;
+
+/// @brief Piece of the frame ring handed out for the current frame
+struct RingSlice
+{
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    /// @brief Host pointer to write the data to, valid until the frame is recycled
+    void *data = nullptr;
+};
+
+/// @brief Persistently mapped buffer of one frame in flight, each FrameContext owning its own.
+/// The frame bump-allocates from it, and it is rewound once the submission of that
+/// frame has completed. Meant for data rewritten every frame (dynamic geometry,
+/// uniforms...), never mapped/unmapped nor reallocated.
+class FrameRing
+{
+private:
+    const Device &_device;
+
+    Buffer _buffer;
+    VkDeviceSize _capacity;
+    /// @brief Alignment used when none is asked for, suitable for uniform and storage buffers
+    VkDeviceSize _defaultAlignment;
+
+    VkDeviceSize _head;
+    /// @brief Renderers may allocate from several recording threads at once
+    std::mutex _mutex;
+
+public:
+    static const VkDeviceSize DefaultCapacity;
+
+    FrameRing(const Device &device, VkDeviceSize capacity = DefaultCapacity);
+    ~FrameRing();
+
+    /// @brief Rewinds the ring for a new frame. Its previous content must no longer be in use by the GPU.
+    void begin();
+
+    /// @brief Reserves `size` bytes for the current frame. Safe to call from several threads
+    /// @param alignment 0 picks the device's uniform/storage offset alignment
+    RingSlice allocate(VkDeviceSize size, VkDeviceSize alignment = 0);
+
+    /// @brief Reserves room for `size` bytes and copies `data` in it
+    RingSlice push(const void *data, VkDeviceSize size, VkDeviceSize alignment = 0);
+
+    // Getters
+    inline const VkBuffer &buffer() const { return _buffer.handle; }
+    inline VkDeviceSize capacity() const { return _capacity; }
+    /// @brief Bytes used so far by the current frame
+    inline VkDeviceSize used() const { return _head; }
+};
@@ -0,0 +1,104 @@
+#pragma once
+#include "global.hpp"
+
+#include <map>
+#include <vector>
+#include <set>
+
+/// @brief How a memory block hands out its sub-ranges
+enum class AllocationStrategy
+{
+    /// @brief Bump allocator, only reclaimed once every allocation inside has been freed
+    Linear,
+    /// @brief First-fit over a sorted list of free ranges, with coalescing on free
+    FreeList,
+    /// @brief Power-of-two buddy allocator, fast and with bounded fragmentation
+    Buddy
+};
+
+/// @brief One large VkDeviceMemory allocation, carved into smaller sub-allocations
+class MemoryBlock
+{
+protected:
+    VkDeviceMemory _memory;
+    VkDeviceSize _size;
+    /// @brief Bytes currently handed out (including buddy rounding)
+    VkDeviceSize _used;
+    uint32_t _allocationCount;
+    uint32_t _memoryType;
+    /// @brief Base pointer of the whole block if it is host visible, nullptr otherwise
+    void *_mapped;
+
+public:
+    MemoryBlock(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType, void *mapped);
+    virtual ~MemoryBlock() = default;
+
+    /// @brief Tries to reserve `size` bytes aligned on `alignment` inside the block
+    /// @param offset Receives the offset of the reserved range on success
+    /// @return false if the block cannot fit the request
+    virtual bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset) = 0;
+    /// @brief Gives back a range previously returned by allocate()
+    virtual void free(VkDeviceSize offset, VkDeviceSize size) = 0;
+
+    // Getters
+    inline const VkDeviceMemory &memory() const { return _memory; }
+    inline VkDeviceSize size() const { return _size; }
+    inline VkDeviceSize used() const { return _used; }
+    inline uint32_t allocationCount() const { return _allocationCount; }
+    inline uint32_t memoryType() const { return _memoryType; }
+    inline void *mapped() const { return _mapped; }
+    inline bool empty() const { return _allocationCount == 0; }
+
+    static inline VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+};
+
+class LinearBlock : public MemoryBlock
+{
+private:
+    VkDeviceSize _head;
+
+public:
+    LinearBlock(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType, void *mapped);
+
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset) override;
+    void free(VkDeviceSize offset, VkDeviceSize size) override;
+};
+
+class FreeListBlock : public MemoryBlock
+{
+private:
+    /// @brief Free ranges, offset -> size, kept sorted so neighbours can be merged
+    std::map<VkDeviceSize, VkDeviceSize> _freeRanges;
+
+public:
+    FreeListBlock(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType, void *mapped);
+
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset) override;
+    void free(VkDeviceSize offset, VkDeviceSize size) override;
+};
+
+class BuddyBlock : public MemoryBlock
+{
+private:
+    /// @brief Smallest node handed out, as a power of two
+    uint32_t _minOrder;
+    uint32_t _maxOrder;
+    /// @brief Free nodes offsets for each order, index 0 is `_minOrder`
+    std::vector<std::set<VkDeviceSize>> _freeNodes;
+    /// @brief Order of every live allocation, needed to find its buddy back
+    std::map<VkDeviceSize, uint32_t> _allocated;
+
+    uint32_t orderFor(VkDeviceSize size) const;
+
+public:
+    /// @param size Must be a power of two
+    BuddyBlock(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType, void *mapped);
+
+    bool allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset) override;
+    void free(VkDeviceSize offset, VkDeviceSize size) override;
+
+    static VkDeviceSize NextPowerOfTwo(VkDeviceSize value);
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "global.hpp"
+
+#include <vector>
+
+// Forward declaration
+class Device;
+
+struct HeapBudget
+{
+    /// @brief Total size of the heap
+    VkDeviceSize size = 0;
+    /// @brief How much the process can use before the driver starts paging or failing allocations
+    VkDeviceSize budget = 0;
+    /// @brief How much the process currently uses, including what isn't allocated through the Allocator
+    VkDeviceSize usage = 0;
+    bool deviceLocal = false;
+
+    inline VkDeviceSize headroom() const { return budget > usage ? budget - usage : 0; }
+    inline float ratio() const { return budget ? static_cast<float>(usage) / static_cast<float>(budget) : 0.0f; }
+};
+
+/// @brief Per-heap memory budget, refreshed once per frame.
+/// Comes from VK_EXT_memory_budget when the device supports it, from the Allocator's own accounting otherwise.
+class MemoryBudget
+{
+private:
+    const Device &_device;
+
+    bool _fromDriver;
+    std::vector<HeapBudget> _heaps;
+
+public:
+    /// @brief Share of a heap considered usable when the driver doesn't tell us
+    static const float FallbackBudgetRatio;
+
+    MemoryBudget(const Device &device, bool extensionEnabled);
+
+    /// @brief Queries the current budgets. Cheap enough to be called every frame
+    void update();
+
+    // Getters
+    inline bool fromDriver() const { return _fromDriver; }
+    inline uint32_t heapCount() const { return static_cast<uint32_t>(_heaps.size()); }
+    inline const HeapBudget &heap(uint32_t index) const { return _heaps[index]; }
+    inline const std::vector<HeapBudget> &heaps() const { return _heaps; }
+
+    /// @brief Smallest headroom among DEVICE_LOCAL heaps, what streaming decisions should look at
+    VkDeviceSize deviceLocalHeadroom() const;
+};
@@ -0,0 +1,58 @@
+#pragma once
+#include "global.hpp"
+
+#include <array>
+#include <vector>
+
+/// @brief What a resource's memory is used for, which decides the memory type it goes in
+enum class MemoryUsage
+{
+    /// @brief Written once (or by the GPU), read by the GPU : plain VRAM
+    GpuOnly,
+    /// @brief Staging memory the CPU fills and the GPU copies from
+    Upload,
+    /// @brief GPU writes, CPU reads back : cached host memory
+    Readback,
+    /// @brief CPU writes every frame, GPU reads directly : VRAM mapped through the BAR when possible. Always coherent
+    Stream
+};
+
+/// @brief Memory properties of the physical device, queried once, along with the preferred memory types of each `MemoryUsage`
+class MemoryTypeTable
+{
+private:
+    VkPhysicalDeviceMemoryProperties _properties;
+    VkDeviceSize _nonCoherentAtomSize;
+
+    /// @brief Candidate memory types per usage, best first
+    std::array<std::vector<uint32_t>, 4> _preferred;
+
+    bool _unifiedMemory;
+    bool _resizableBar;
+
+    void buildPreferred(MemoryUsage usage, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, VkMemoryPropertyFlags avoided);
+
+public:
+    /// @brief Size of the classic BAR window : a DEVICE_LOCAL | HOST_VISIBLE heap bigger than this is resizable BAR
+    static const VkDeviceSize BarWindowSize;
+
+    MemoryTypeTable(const VkPhysicalDevice &physical);
+
+    /// @brief First memory type allowed by `typeFilter` holding all of `properties`
+    uint32_t find(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+    /// @brief Best memory type allowed by `typeFilter` for `usage`
+    uint32_t find(uint32_t typeFilter, MemoryUsage usage) const;
+
+    // Getters
+    inline const VkPhysicalDeviceMemoryProperties &properties() const { return _properties; }
+    inline VkMemoryPropertyFlags flags(uint32_t memoryType) const { return _properties.memoryTypes[memoryType].propertyFlags; }
+    inline uint32_t heapIndex(uint32_t memoryType) const { return _properties.memoryTypes[memoryType].heapIndex; }
+    inline VkDeviceSize nonCoherentAtomSize() const { return _nonCoherentAtomSize; }
+
+    /// @brief Integrated GPU : there is only one kind of memory, all of it device local
+    inline bool unifiedMemory() const { return _unifiedMemory; }
+    /// @brief Discrete GPU exposing the whole VRAM to the CPU
+    inline bool resizableBar() const { return _resizableBar; }
+    /// @brief Device local memory can be written directly by the CPU, so static data needs no staging copy
+    inline bool directUpload() const { return _unifiedMemory || _resizableBar; }
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include "global.hpp"
+
+#include <memory/Allocator.hpp>
+
+#include <vector>
+
+// Forward declaration
+class Device;
+
+/// @brief What the graphics submission of the frame has to wait on before reading uploaded data
+struct UploadSync
+{
+    /// @brief Transfer timeline value to wait for, 0 if there is nothing to wait on
+    uint64_t value = 0;
+    /// @brief Stages that consume the uploaded data, to be used as wait stage for `value`
+    VkPipelineStageFlags stages = 0;
+};
+
+/// @brief Copies data into DEVICE_LOCAL buffers through a ring staging buffer.
+/// Copies are recorded as they come and submitted as a single batch per frame on
+/// the transfer queue, with queue ownership handed over to the graphics family.
+class Uploader
+{
+private:
+    struct Batch
+    {
+        VkCommandBuffer command = VK_NULL_HANDLE;
+        /// @brief Transfer timeline value signaled when the batch is done
+        uint64_t value = 0;
+        /// @brief Ring position right after this batch's data, becomes the tail once it retires
+        VkDeviceSize stagingEnd = 0;
+    };
+
+    const Device &_device;
+
+    VkCommandPool _pool;
+    std::vector<Batch> _batches;
+    uint64_t _submitted;
+    uint64_t _retired;
+    bool _recording;
+    /// @brief Transfer timeline value handed to the graphics queue by the last flush()
+    uint64_t _flushed;
+
+    // Ring staging buffer, positions are virtual and wrap modulo `_capacity`
+    Buffer _staging;
+    VkDeviceSize _capacity;
+    VkDeviceSize _head;
+    VkDeviceSize _tail;
+
+    /// @brief Ownership acquires for the copies not flushed yet
+    std::vector<VkBufferMemoryBarrier> _queuedAcquires;
+    /// @brief Ownership acquires the next graphics command buffer must record
+    std::vector<VkBufferMemoryBarrier> _readyAcquires;
+    std::vector<VkBufferMemoryBarrier> _releases;
+    VkPipelineStageFlags _queuedStages;
+    VkPipelineStageFlags _readyStages;
+
+    void begin();
+    void submit();
+    /// @brief Recycles finished batches and their staging space
+    /// @param waitOldest Block on the oldest batch if it is still running
+    void retire(bool waitOldest);
+    /// @brief Reserves `size` contiguous bytes of staging memory, flushing and waiting if the ring is full
+    /// @return Offset inside the staging buffer
+    VkDeviceSize reserve(VkDeviceSize size);
+
+public:
+    static const VkDeviceSize DefaultCapacity;
+    static const uint32_t BatchCount;
+
+    Uploader(const Device &device, VkDeviceSize capacity = DefaultCapacity);
+    ~Uploader();
+
+    /// @brief Creates a buffer the GPU reads from, filled with `data`.
+    /// Lands in CPU-writable device local memory on UMA and resizable BAR setups, skipping the staging copy
+    Buffer createBuffer(const void *data, VkDeviceSize size, VkBufferUsageFlags usage,
+                        VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                        VkAccessFlags dstAccess = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT);
+
+    /// @brief Queues a copy of `size` bytes from `data` into `dst` at `dstOffset`.
+    /// The data is copied into staging memory right away, so `data` may be released on return.
+    /// Host visible destinations are written directly.
+    /// @param dstStage Stages that will read the buffer on the graphics queue
+    /// @param dstAccess Accesses that will read the buffer on the graphics queue
+    void enqueue(const void *data, VkDeviceSize size, const Buffer &dst, VkDeviceSize dstOffset = 0,
+                 VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                 VkAccessFlags dstAccess = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT);
+
+    /// @brief Submits every queued copy as one batch. Called once per frame, before recording.
+    /// @return Transfer timeline value the graphics submission must wait on, 0 if nothing was uploaded
+    UploadSync flush();
+
+    /// @brief Records the queue ownership acquires matching the last flush(), if any
+    void recordAcquireBarriers(const VkCommandBuffer &commandBuffer);
+
+    /// @brief Blocks until every submitted upload has completed
+    void waitIdle();
+};
@@ -9,9 +9,14 @@
 #include <Device.hpp>
 #include <SwapChain.hpp>
 #include <GraphicsPipeline.hpp>
+#include <GpuProfiler.hpp>
+#include <PipelineStatistics.hpp>
 
-#include <ui/UIRenderPass.hpp>
-#include <ui/UICommandPool.hpp>
+#include <default/DefaultRenderPass.hpp>
+#include <ui/UIRenderer.hpp>
+#include <ui/UIDrawData.hpp>
+
+#include <chrono>
 
 class UI
 {
@@ -20,22 +25,60 @@ private:
     const Device &_device;
     const SwapChain &_swapChain;
     const GraphicsPipeline &_graphicsPipeline;
+    const GpuProfiler &_gpuProfiler;
+    const PipelineStatistics &_pipelineStatistics;
 
-    UIRenderPass _renderPass;
-    UICommandPool _commandPool;
+    /// @brief Scene pass the UI is drawn in, as its overlay subpass
+    const DefaultRenderPass &_renderPass;
+    UIRenderer _renderer;
+    /// @brief Nothing of it is used : the draw data is the UI's state
+    DrawState _rendererState;
     VkDescriptorPool _imGuiDescriptorPool;
+    /// @brief Present modes of the surface, copied once : the swapchain belongs to the render thread
+    std::vector<VkPresentModeKHR> _presentModes;
 
     void createImGuiDescriptorPool();
+    /// @brief Last headless frame, ImGui's clock when there is no GLFW backend to keep it
+    std::chrono::steady_clock::time_point _lastFrame;
+
+    /// @brief Usage and budget of every memory heap
+    void drawMemoryPanel();
+    /// @brief GPU time of the last frame read back, per scope, and of each scope over the profiler's history
+    void drawGpuPanel();
+    /// @brief Vertex and fragment counts of each pass of the last frame read back, with the ratios they hint at
+    void drawStatisticsPanel();
+    /// @brief What the GLFW backend does each frame, minus the input
+    void newHeadlessFrame();
 
 public:
-    UI(const Window &window, const Device &device, const SwapChain &swapChain, const GraphicsPipeline &graphicsPipeline);
+    /// @brief Frames in flight asked for through the UI, applied by the application between frames
+    int framesInFlight;
+    /// @brief Present mode asked for through the UI, applied on the render thread by recreating the swapchain
+    VkPresentModeKHR presentMode;
+    /// @brief Cap of the main loop in frames per second, 0 for none
+    int fpsCap;
+    /// @brief Presents the latency limiter lets wait for the screen, 0 to disable it
+    int maxQueuedFrames;
+    /// @brief Pipeline statistics asked for through the UI, turned on by the render thread
+    bool pipelineStatistics;
+    /// @brief F12 or the UI button : the application writes a CPU trace, then clears it
+    bool traceRequested;
+
+    UI(const Window &window, const Device &device, const SwapChain &swapChain, const DefaultRenderPass &renderPass, const GraphicsPipeline &graphicsPipeline, const GpuProfiler &gpuProfiler,
+       const PipelineStatistics &pipelineStatistics, uint32_t framesInFlight);
     ~UI();
 
-    inline VkCommandBuffer &command(uint32_t index) { return _commandPool.command(index); }
-    inline const VkCommandBuffer &command(uint32_t index) const { return _commandPool.command(index); }
-    void recordCommandBuffers(uint32_t bufferIdx) { _commandPool.recordCommandBuffer(bufferIdx); }
+    /// @brief Secondary command buffer drawing `drawData`, to execute in the overlay subpass.
+    /// Doesn't touch the ImGui context, so it can run on the render thread while the main thread builds the next UI
+    VkCommandBuffer record(FrameContext &frame, uint32_t imageIndex, UIDrawData &drawData, PipelineStatistics *statistics = nullptr)
+    {
+        _renderer.setDrawData(drawData.drawData());
+        return _renderer.secondary(frame, DefaultRenderPass::OverlaySubpass, imageIndex, _rendererState, statistics, "UI");
+    }
 
-    void recreate();
+    /// @brief Passes the image count of a recreated swapchain on to the ImGui backend. Render thread, right after the recreation
+    void swapChainRecreated();
 
+    /// @brief Builds the UI of the frame. Main thread only, as ImGui polls GLFW (unless headless)
     void draw();
 };
\ No newline at end of file
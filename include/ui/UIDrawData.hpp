@@ -0,0 +1,27 @@
+#pragma once
+#include "global.hpp"
+
+#include <imgui.h>
+
+/// @brief Copy of the ImGui draw data of a frame. The original belongs to the ImGui context, and is rewritten
+/// by the next ImGui::NewFrame() : the copy can be drawn from another thread while the next frame is built
+class UIDrawData
+{
+private:
+    /// @brief Its command lists are clones owned by this object
+    ImDrawData _drawData;
+
+public:
+    UIDrawData() = default;
+    ~UIDrawData();
+
+    UIDrawData(const UIDrawData &) = delete;
+    UIDrawData &operator=(const UIDrawData &) = delete;
+
+    /// @brief Replaces the copy with `source`, usually ImGui::GetDrawData() right after ImGui::Render()
+    void capture(const ImDrawData *source);
+    void clear();
+
+    // Getters
+    inline ImDrawData *drawData() { return &_drawData; }
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include "global.hpp"
+
+#include <Renderer.hpp>
+
+// Forward declaration
+struct ImDrawData;
+
+/// @brief Records the Dear ImGui draw data, in the overlay subpass of the scene pass
+class UIRenderer : public Renderer
+{
+private:
+    /// @brief Draw data to record, ImGui's own if null
+    ImDrawData *_drawData;
+
+public:
+    UIRenderer(const Device &device, const RenderPass &renderPass, const SwapChain &swapChain, const GraphicsPipeline &graphicsPipeline);
+
+    /// @brief Draw data recorded from now on, e.g a copy made for the render thread
+    inline void setDrawData(ImDrawData *drawData) { _drawData = drawData; }
+
+    /// @brief Draws the draw data set last, `state` is unused
+    void record(VkCommandBuffer commandBuffer, FrameContext &frame, const DrawState &state) override;
+    /// @brief The draw data is rebuilt every frame
+    bool cacheable(const DrawState &state) const override { return false; }
+};
@@ -3,19 +3,69 @@
 
 #include <vector>
 #include <cstring>
+#include <string>
 
-int main()
+static void PrintUsage(const char *program)
 {
-    glfwInit();
+    std::cerr << "Usage : " << program << " [--headless] [--frames N] [--readback file.ppm] [--trace file.json] [--trace-frames N]"
+              << " [--ring-mb N] [--no-validation]\n";
+}
 
-    // Remove OpenGL API
-    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-    glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+int main(int argc, char **argv)
+{
+    HeadlessSettings headless;
+    TraceSettings trace;
+    VkDeviceSize ringCapacity = FrameRing::DefaultCapacity;
+    bool enableValidationLayers = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--headless") == 0)
+            headless.enabled = true;
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            headless.frameCount = std::stoull(argv[++i]);
+        else if (strcmp(argv[i], "--readback") == 0 && i + 1 < argc)
+            headless.readbackPath = argv[++i];
+        // Written at exit, and where F12 writes it
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            trace.path = argv[++i];
+            trace.atExit = true;
+        }
+        else if (strcmp(argv[i], "--trace-frames") == 0 && i + 1 < argc)
+            trace.frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+        // Per frame in flight, for scenes streaming a lot of vertices
+        else if (strcmp(argv[i], "--ring-mb") == 0 && i + 1 < argc)
+            ringCapacity = std::stoull(argv[++i]) * 1024 * 1024;
+        else if (strcmp(argv[i], "--no-validation") == 0)
+            enableValidationLayers = false;
+        else
+        {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
 
-    Application app(true);
+    if (!headless.readbackPath.empty() && headless.frameCount == 0)
+    {
+        std::cerr << "--readback needs --frames : the last frame is the one read back\n";
+        return EXIT_FAILURE;
+    }
+
+    // Headless runs go without GLFW at all : there may not even be a display to initialize it against
+    if (!headless.enabled)
+    {
+        glfwInit();
+
+        // Remove OpenGL API
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    }
 
     try
     {
+        Application app(enableValidationLayers, DEFAULT_FRAMES_IN_FLIGHT, headless);
+        app.setTrace(trace);
+        app.setFrameRingCapacity(ringCapacity);
         app.run();
     }
     catch (const std::exception &e)
@@ -24,7 +74,8 @@ int main()
         return EXIT_FAILURE;
     }
 
-    glfwTerminate();
+    if (!headless.enabled)
+        glfwTerminate();
 
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -1,85 +1,365 @@
 #include <Application.hpp>
 
+#include <memory/MemoryBudget.hpp>
+#include <DeletionQueue.hpp>
+#include <Scheduler.hpp>
+#include <geometry/MeshFile.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
 const uint32_t WIDTH = 800;
 const uint32_t HEIGHT = 600;
 
-const int MAX_FRAMES_IN_FLIGHT = 5;
-
 const std::vector<Vertex> testVertices = {
     {{0.0f, -0.5f, 0.0f}, {1.0f, 1.0f, 1.0f}},
     {{0.5f, 0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}},
     {{-0.5f, 0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}}};
 
-Application::Application(bool enableValidationLayers) : window("Test", {WIDTH, HEIGHT}, "Vulkan", enableValidationLayers),
-                                                        debugMessenger(window),
-                                                        device(window),
-                                                        swapChain(device, window),
-                                                        defaultRenderPass(device, swapChain),
-                                                        graphicsPipeline(device, swapChain, defaultRenderPass, {ShaderInfo("base", true), ShaderInfo("base", false)}),
-                                                        renderer(device, defaultRenderPass, swapChain, graphicsPipeline, 0, testVertices),
-                                                        sync(device, swapChain.numImages(), MAX_FRAMES_IN_FLIGHT),
-                                                        interface(window, device, swapChain, graphicsPipeline)
+static Mesh BuildMesh(const std::vector<Vertex> &triangles)
 {
+    MeshBuilder builder;
+    builder.addTriangles(triangles);
+    return builder.build();
 }
 
-void Application::drawFrame(bool &resized)
+/// @brief Maps a cooked mesh from the assets, cooking `fallback` into it first if it is missing or was cooked from
+/// other vertices, another vertex layout or another version of the format
+static MeshFile LoadMesh(const std::string &name, const std::vector<Vertex> &fallback)
 {
-    // Wait for the previous frame to be rendered
-    vkWaitForFences(device.logical(), 1, &sync.inFlightFence(currentFrame), VK_TRUE, UINT64_MAX);
+    std::string path = MESHES_PATH + name + ".vkbm";
+    uint64_t sourceHash = MeshFile::Hash(fallback.data(), fallback.size() * sizeof(Vertex));
+    if (!MeshFile::UpToDate(path, sourceHash))
+    {
+        std::filesystem::create_directories(MESHES_PATH);
+        MeshFile::Write(path, BuildMesh(fallback), sourceHash);
+    }
+
+    return MeshFile(path);
+}
+
+Application::Application(bool enableValidationLayers, uint32_t framesInFlight, const HeadlessSettings &headlessSettings) : jobs(JobSystem::AutoWorkers, 1),
+                                                                                                                          headless(headlessSettings),
+                                                                                                                          window("Test", {WIDTH, HEIGHT}, "Vulkan", enableValidationLayers, headless.enabled),
+                                                                                                                          debugMessenger(window),
+                                                                                                                          device(window),
+                                                                                                                          // Read back through a copy, which the images must allow
+                                                                                                                          swapChain(device, window, headless.readbackPath.empty() ? 0 : VK_IMAGE_USAGE_TRANSFER_SRC_BIT),
+                                                                                                                          defaultRenderPass(device, swapChain, device.dynamicRenderingEnabled()),
+                                                                                                                          graphicsPipeline(device, swapChain, defaultRenderPass, {ShaderInfo("base", true), ShaderInfo("base", false)}),
+                                                                                                                          renderer(device, defaultRenderPass, swapChain, graphicsPipeline, LoadMesh("triangle", testVertices)),
+                                                                                                                          sync(device, swapChain.numImages()),
+                                                                                                                          gpuProfiler(device),
+                                                                                                                          pipelineStatistics(device),
+                                                                                                                          interface(window, device, swapChain, defaultRenderPass, graphicsPipeline, gpuProfiler, pipelineStatistics, framesInFlight),
+                                                                                                                          scene({&renderer}),
+                                                                                                                          recorder(device, jobs),
+                                                                                                                          presentPacer(device, swapChain)
+{
+    setFramesInFlight(framesInFlight);
+
+    if (!headless.readbackPath.empty())
+        readback = std::make_unique<Readback>(device, swapChain);
+    timings.reserve(headless.frameCount);
+}
+
+void Application::setFramesInFlight(uint32_t count)
+{
+    count = std::clamp(count, 1u, FrameContext::MaxFramesInFlight);
+
+    // The contexts about to be destroyed may still be in use by the GPU : wait for the last graphics submission only
+    Timeline &graphics = device.scheduler().timeline(QueueType::Graphics);
+    graphics.wait(graphics.pending());
+
+    frames.clear();
+    for (uint32_t i = 0; i < count; i++)
+        frames.push_back(std::make_unique<FrameContext>(device, jobs.threadCount(), frameRingCapacity));
+
+    framesInFlight = count;
+    currentFrame = 0;
+}
+
+void Application::setFrameRingCapacity(VkDeviceSize capacity)
+{
+    if (capacity == frameRingCapacity)
+        return;
+
+    frameRingCapacity = capacity;
+    setFramesInFlight(framesInFlight);
+}
+
+void Application::update(bool &resized)
+{
+    CPU_ZONE("Update");
+
+    // Whatever the workers need done on the main thread (GLFW calls mostly)
+    jobs.pumpMain();
+
+    if (renderFailed)
+        std::rethrow_exception(renderError);
+
+    // Headless run over : no window for the user to close
+    if (headlessDone)
+    {
+        window.close();
+        return;
+    }
+
+    if (resized)
+    {
+        resizeCount++;
+        resized = false;
+    }
+
+    // Minimized : nothing to draw until the window comes back
+    glm::ivec2 size;
+    window.framebufferSize(size);
+    if (size[0] == 0 || size[1] == 0)
+    {
+        glfwWaitEvents();
+        return;
+    }
+
+    // Fresh heap budgets, for the UI and anything deciding what to keep resident
+    device.budget().update();
+    {
+        CPU_ZONE("UI::draw");
+        interface.draw();
+    }
+    interface.framesInFlight = std::clamp(interface.framesInFlight, 1, static_cast<int>(FrameContext::MaxFramesInFlight));
+
+    // Fill the free packet : reusing it keeps the draw list allocation from one round to the next
+    RenderPacket &packet = packets.back();
+    packet.frameNumber = packetNumber++;
+    packet.drawList.assign(scene.begin(), scene.end());
+    packet.drawStates.resize(packet.drawList.size());
+    {
+        CPU_ZONE("CaptureDrawStates");
+        for (size_t i = 0; i < packet.drawList.size(); i++)
+            packet.drawList[i]->captureState(packet.drawStates[i]);
+    }
+    packet.ui.capture(ImGui::GetDrawData());
+    packet.framesInFlight = static_cast<uint32_t>(interface.framesInFlight);
+    packet.presentMode = interface.presentMode;
+    packet.maxQueuedFrames = static_cast<uint32_t>(std::max(interface.maxQueuedFrames, 0));
+    packet.resizeCount = resizeCount;
+    packet.framebufferSize = size;
+    packet.pipelineStatistics = interface.pipelineStatistics;
+
+    packets.publish();
+
+    // Without a cap, nothing else paces this thread : building packets the render thread replaces before drawing them
+    // would only burn a core. Returns as soon as it takes this one, so the next packet is still built during the frame
+    {
+        CPU_ZONE("WaitConsumed");
+        packets.waitConsumed();
+    }
+
+    if (interface.traceRequested)
+    {
+        interface.traceRequested = false;
+        writeTrace();
+    }
+
+    // Sleep off the rest of the frame, if capped
+    CPU_ZONE("FrameLimiter");
+    frameLimiter.setTargetFps(static_cast<uint32_t>(std::max(interface.fpsCap, 0)));
+    frameLimiter.wait();
+}
+
+void Application::renderLoop()
+{
+    jobs.adoptThread(0);
+    CPU_THREAD_NAME("Render");
+
+    try
+    {
+        // Headless, exactly the frames asked for
+        while (!headlessDone)
+        {
+            // Limiter first : the packet taken right after it is the freshest one
+            {
+                CPU_ZONE("PresentPacer");
+                presentPacer.wait();
+            }
+
+            RenderPacket *packet = packets.acquire();
+            if (!packet)
+                break;
+            drawFrame(*packet);
+        }
+    }
+    catch (...)
+    {
+        renderError = std::current_exception();
+        renderFailed = true;
+    }
+
+    // Nothing will take the packets anymore : the main thread mustn't wait for it to
+    packets.close();
+}
+
+void Application::stopRenderThread()
+{
+    if (!renderThread.joinable())
+        return;
+
+    packets.close();
+    renderThread.join();
+}
+
+void Application::collectQueryResults()
+{
+    for (GpuFrameResult &result : gpuProfiler.collect())
+        if (result.frameNumber < timings.size())
+        {
+            timings[result.frameNumber].gpuMs = result.scopes.front().ms;
+            timings[result.frameNumber].gpuScopes = std::move(result.scopes);
+        }
+
+    for (FrameStatistics &result : pipelineStatistics.collect())
+        if (result.frameNumber < timings.size())
+            timings[result.frameNumber].passStatistics = std::move(result.passes);
+}
+
+void Application::pushGpuScope(FrameContext &frame, uint32_t subpass, uint32_t imageIndex, const char *name)
+{
+    if (!gpuProfiler.enabled())
+        return;
+
+    VkCommandBuffer commandBuffer = frame.secondaryPool(JobSystem::ThreadIndex()).acquire();
+    defaultRenderPass.beginSecondary(commandBuffer, subpass, imageIndex, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+    if (name)
+        gpuProfiler.begin(commandBuffer, name);
+    else
+        gpuProfiler.end(commandBuffer);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to record GPU scope!");
+
+    subpassCommands.push_back(commandBuffer);
+}
+
+void Application::writeTrace()
+{
+    if (!CpuProfiler::Enabled)
+    {
+        std::cerr << "No CPU trace : built without VKBULLSHIT_PROFILER\n";
+        return;
+    }
+
+    CpuProfiler::WriteTrace(trace.path, trace.frames);
+    std::cout << "CPU trace of the last " << trace.frames << " frames written to " << trace.path << '\n';
+}
+
+void Application::drawFrame(RenderPacket &packet)
+{
+    CPU_ZONE("DrawFrame");
+    using Clock = std::chrono::steady_clock;
+    auto frameStart = Clock::now();
+
+    // Frames in flight changed through the UI : applied between two frames
+    if (packet.framesInFlight != framesInFlight)
+        setFramesInFlight(packet.framesInFlight);
+
+    presentPacer.setMaxQueuedFrames(packet.maxQueuedFrames);
+    pipelineStatistics.setActive(packet.pipelineStatistics);
+
+    // A new present mode needs a new swapchain, same as a resize
+    if (packet.presentMode != swapChain.requestedPresentMode())
+    {
+        swapChain.setPresentMode(packet.presentMode);
+        swapChainOutdated = true;
+    }
+
+    bool resized = packet.resizeCount != handledResizes;
+    handledResizes = packet.resizeCount;
+    swapChain.setFramebufferSize(packet.framebufferSize);
+
+    if (swapChainOutdated)
+    {
+        recreateSwapChain();
+        if (swapChainOutdated)
+            return;
+        resized = false;
+    }
+
+    FrameContext &frame = *frames[currentFrame];
+
+    // Wait for the last frame rendered with this context
+    {
+        CPU_ZONE("WaitFrame");
+        frame.wait();
+    }
+    collectQueryResults();
+
+    // The GPU is done with this context : its command buffers and streamed data can be reused
+    frame.begin(frameNumber);
+    // Same goes for whatever was retired by the submissions the GPU has finished
+    device.deletionQueue().collect();
 
     // Acquire image for current frame in swapchain. Disables the timeout by putting a very high value
     uint32_t imageIndex;
-    auto result = vkAcquireNextImageKHR(device.logical(), swapChain.handle(), UINT64_MAX, sync.imageAvailable(currentFrame), VK_NULL_HANDLE, &imageIndex);
+    VkResult result;
+    {
+        CPU_ZONE("Acquire");
+        result = vkAcquireNextImageKHR(device.logical(), swapChain.handle(), UINT64_MAX, frame.imageAvailable(), VK_NULL_HANDLE, &imageIndex);
+    }
 
-    // Create new swap chain if needed
+    // Create new swap chain if needed, and draw the packet on it right away : dropping the frame
+    // is what makes live resizes stutter. The semaphore wasn't signaled by the failed acquire, so it can be reused
     if (result == VK_ERROR_OUT_OF_DATE_KHR)
     {
-        recreateSwapChain(resized);
-        return;
-    }
-    else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
-        throw std::runtime_error("Failed to acquire swapchain image");
+        recreateSwapChain();
+        if (swapChainOutdated)
+            return;
+        // Already at the new size : no need to rebuild it again after presenting
+        resized = false;
 
-    // Wait for image in flight
-    if (sync.imageInFlight(imageIndex) != VK_NULL_HANDLE)
-        vkWaitForFences(device.logical(), 1, &sync.imageInFlight(imageIndex),
-                        VK_TRUE, UINT64_MAX);
+        result = vkAcquireNextImageKHR(device.logical(), swapChain.handle(), UINT64_MAX, frame.imageAvailable(), VK_NULL_HANDLE, &imageIndex);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR)
+        {
+            // Resized again meanwhile : next packet
+            swapChainOutdated = true;
+            return;
+        }
+    }
 
-    // Update semaphores
-    sync.imageInFlight(imageIndex) = sync.inFlightFence(currentFrame);
+    if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR)
+        throw std::runtime_error("Failed to acquire swapchain image");
 
-    // Reset the current command buffers, so that they may be used again
-    vkResetCommandBuffer(renderer.command(currentFrame), 0);
-    vkResetCommandBuffer(interface.command(currentFrame), 0);
+    // No wait on the image itself : the acquire semaphore orders the writes after its presentation,
+    // and nothing recorded is tied to the image anymore
 
-    // Re-record the command buffers for the current frame/image
-    interface.recordCommandBuffers(currentFrame);
-    renderer.recordCommandBuffer(currentFrame);
+    // Push this frame's uploads in a single transfer submission
+    UploadSync upload = device.uploader().flush();
 
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    // Re-record the frame in one of the frame's own buffers, drawing to the acquired image
+    VkCommandBuffer commandBuffer = frame.commandPool().acquire();
+    auto recordStart = Clock::now();
+    recordFrame(commandBuffer, frame, imageIndex, packet);
+    auto recordEnd = Clock::now();
 
-    VkSemaphore waitSemaphores[] = {sync.imageAvailable(currentFrame)};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;
-    submitInfo.pWaitDstStageMask = waitStages;
+    // The acquired image (binary, from the swapchain) and this frame's uploads (transfer timeline)
+    SemaphoreWait waits[] = {{frame.imageAvailable(), 0, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT},
+                             device.scheduler().after(QueueType::Transfer, upload.value, upload.stages)};
+    uint32_t waitCount = upload.value != 0 ? 2 : 1;
 
     // Set command buffers to give (UI + simulation)
-    VkCommandBuffer buffers[] = {renderer.command(currentFrame), interface.command(currentFrame)};
-    submitInfo.commandBufferCount = 2;
-    submitInfo.pCommandBuffers = buffers;
+    VkCommandBuffer buffers[] = {commandBuffer};
 
-    // Setup waiting semaphores
-    VkSemaphore signalSemaphores[] = {sync.renderFinished(currentFrame)};
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = signalSemaphores;
+    // Presentation can only wait on a binary semaphore : one per image, as presentation may still be waiting on it when this context comes back around
+    VkSemaphore signalSemaphores[] = {sync.renderFinished(imageIndex)};
 
-    // Reset the fence, to not pend infinitely
-    vkResetFences(device.logical(), 1, &sync.inFlightFence(currentFrame));
-
-    if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, sync.inFlightFence(currentFrame)) != VK_SUCCESS)
-        throw std::runtime_error("failed to submit draw command buffer!");
+    uint64_t submission;
+    {
+        CPU_ZONE("Submit");
+        submission = device.scheduler().submit(QueueType::Graphics, buffers, {waits, waitCount}, signalSemaphores);
+    }
+    frame.submitted(submission);
+    auto submitEnd = Clock::now();
 
     // Now, onto the frame presentation !
     VkPresentInfoKHR presentInfo{};
@@ -95,25 +375,118 @@ void Application::drawFrame(bool &resized)
     presentInfo.pImageIndices = &imageIndex;
     // Simply not used
     presentInfo.pResults = nullptr;
+    // Tag the present for the latency limiter
+    presentPacer.attach(presentInfo);
 
     // Finally, try to present queue
-    result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
-
-    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || resized)
     {
-        recreateSwapChain(resized);
-        resized = false;
+        CPU_ZONE("Present");
+        result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
     }
+
+    if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || resized)
+        recreateSwapChain();
     else if (result != VK_SUCCESS)
     {
         throw std::runtime_error("Failed to present swap chain image");
     }
 
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    // Only blocks on the very last frame, which nothing is rendered after anyway
+    if (readsBack())
+    {
+        CPU_ZONE("Readback");
+        device.scheduler().timeline(QueueType::Graphics).wait(submission);
+        readback->save(headless.readbackPath);
+    }
+
+    // GPU time filled in once the context comes back around
+    if (headless.frameCount != 0)
+    {
+        FrameTimings frameTimings;
+        frameTimings.frameNumber = frameNumber;
+        frameTimings.cpuMs = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+        frameTimings.recordMs = std::chrono::duration<double, std::milli>(recordEnd - recordStart).count();
+        frameTimings.submitMs = std::chrono::duration<double, std::milli>(submitEnd - recordEnd).count();
+        timings.push_back(frameTimings);
+    }
+
+    currentFrame = (currentFrame + 1) % framesInFlight;
+    frameNumber++;
+
+    if (headless.frameCount != 0 && frameNumber >= headless.frameCount)
+        headlessDone = true;
+}
+
+void Application::recordFrame(VkCommandBuffer commandBuffer, FrameContext &frame, uint32_t imageIndex, RenderPacket &packet)
+{
+    CPU_ZONE("Record");
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin recording command buffer!");
+    gpuProfiler.beginFrame(commandBuffer, frameNumber);
+    pipelineStatistics.beginFrame(commandBuffer, frameNumber);
+
+    // Take ownership of freshly uploaded buffers before the render pass reads them
+    device.uploader().recordAcquireBarriers(commandBuffer);
+
+    // Both subpasses only execute secondary buffers : the scene ones are recorded by the job system (or replayed from the cache
+    // when the scene is small), and keeping the same contents lets dynamic rendering go on without restarting
+    JobCounter sceneRecorded;
+    recorder.record(frame, defaultRenderPass, DefaultRenderPass::SceneSubpass, imageIndex, packet.drawList, packet.drawStates, sceneRecorded,
+                    &pipelineStatistics, "Scene");
+
+    // The UI is recorded here meanwhile, then this thread helps with the scene
+    VkCommandBuffer uiCommands;
+    {
+        CPU_ZONE("RecordUI");
+        uiCommands = interface.record(frame, imageIndex, packet.ui, &pipelineStatistics);
+    }
+    {
+        CPU_ZONE("WaitScene");
+        jobs.wait(sceneRecorded);
+    }
+    std::span<const VkCommandBuffer> sceneCommands = recorder.commandBuffers();
+
+    // ------------- BEGINNING RENDER PASS ------------------
+    defaultRenderPass.begin(commandBuffer, imageIndex, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    subpassCommands.clear();
+    pushGpuScope(frame, DefaultRenderPass::SceneSubpass, imageIndex, "Scene");
+    subpassCommands.insert(subpassCommands.end(), sceneCommands.begin(), sceneCommands.end());
+    pushGpuScope(frame, DefaultRenderPass::SceneSubpass, imageIndex, nullptr);
+    if (!subpassCommands.empty())
+        vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(subpassCommands.size()), subpassCommands.data());
+
+    // UI on top, without the image leaving the render pass
+    defaultRenderPass.nextSubpass(commandBuffer, imageIndex, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    subpassCommands.clear();
+    pushGpuScope(frame, DefaultRenderPass::OverlaySubpass, imageIndex, "UI");
+    subpassCommands.push_back(uiCommands);
+    pushGpuScope(frame, DefaultRenderPass::OverlaySubpass, imageIndex, nullptr);
+    vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(subpassCommands.size()), subpassCommands.data());
+
+    defaultRenderPass.end(commandBuffer, imageIndex);
+
+    if (readsBack())
+        readback->record(commandBuffer, imageIndex);
+    gpuProfiler.endFrame(commandBuffer);
+    pipelineStatistics.endFrame();
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to record command buffer!");
 }
 
 Application::~Application()
 {
+    // Still running if the main loop threw, in which case the device isn't idle yet either
+    stopRenderThread();
+    vkDeviceWaitIdle(device.logical());
+
+    // Run the pending destructions while their owners (pools...) still exist
+    device.deletionQueue().flush();
 }
 
 void Application::run()
@@ -123,37 +496,53 @@ void Application::run()
     std::cout << "Application closing...\n";
 }
 
-void Application::mainLoop()
+void Application::buildScene(const SceneBuilder &builder)
 {
-    window.setDrawFrameFunc([this](bool &framebufferResized)
-                            {
-                                interface.draw();
-                                drawFrame(framebufferResized); });
-
-    window.mainLoop(device);
+    scene = builder(device, defaultRenderPass, swapChain);
 }
 
-void Application::recreateSwapChain(bool &resized)
+void Application::mainLoop()
 {
-    resized = true;
+    CPU_THREAD_NAME("Main");
 
-    glm::ivec2 size;
-    window.framebufferSize(size);
-    while (size[0] == 0 || size[1] == 0)
-    {
-        window.framebufferSize(size);
-        glfwWaitEvents();
-    }
+    // The main thread keeps GLFW and ImGui, the render thread does everything Vulkan from here on
+    renderThread = std::thread(&Application::renderLoop, this);
+
+    window.setDrawFrameFunc([this](bool &framebufferResized)
+                            { update(framebufferResized); });
+
+    window.mainLoop();
+
+    stopRenderThread();
+    if (renderFailed)
+        std::rethrow_exception(renderError);
 
     vkDeviceWaitIdle(device.logical());
 
-    swapChain.recreate();
-    defaultRenderPass.recreate();
-    graphicsPipeline.recreate();
-    renderer.recreateCommandBuffers();
+    // The last frames never came back around
+    collectQueryResults();
+
+    if (trace.atExit)
+        writeTrace();
+}
 
-    interface.recreate();
+void Application::recreateSwapChain()
+{
+    CPU_ZONE("RecreateSwapChain");
+
+    // Minimized since the packet was built : no swapchain can have an empty extent.
+    // Retried on the next packet, which the main thread only publishes once the window is restored
+    VkSurfaceCapabilitiesKHR capabilities;
+    vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device.physical(), window.surface(), &capabilities);
+    swapChainOutdated = capabilities.currentExtent.width == 0 || capabilities.currentExtent.height == 0;
+    if (swapChainOutdated)
+        return;
 
-    defaultRenderPass.cleanupOld();
-    swapChain.cleanupOld();
+    // No need to wait for the device : everything replaced here is destroyed through the deletion queue,
+    // once the frames still in flight are done with it
+    // Only what depends on the images or their extent is rebuilt, cached secondary buffers notice the new extent on their own
+    swapChain.recreate();
+    defaultRenderPass.recreate();
+    sync.recreate(swapChain.numImages());
+    interface.swapChainRecreated();
 }
\ No newline at end of file
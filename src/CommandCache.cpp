@@ -0,0 +1,74 @@
+#include <CommandCache.hpp>
+#include <Device.hpp>
+#include <DeletionQueue.hpp>
+
+bool CommandKey::operator==(const CommandKey &other) const
+{
+    return pipeline == other.pipeline && framebuffer == other.framebuffer &&
+           extent.width == other.extent.width && extent.height == other.extent.height &&
+           generation == other.generation && version == other.version;
+}
+
+CommandCache::CommandCache(const Device &device) : _device(device),
+                                                   _hits(0),
+                                                   _misses(0)
+{
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    // Buffers live long and are never reset, only freed
+    poolInfo.flags = 0;
+    poolInfo.queueFamilyIndex = _device.queueFamilyIndices().graphicsFamily.value();
+
+    if (vkCreateCommandPool(_device.logical(), &poolInfo, nullptr, &_pool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create command cache pool!");
+}
+
+CommandCache::~CommandCache()
+{
+    // Buffers freed through the deletion queue must go before their pool
+    clear();
+    _device.deletionQueue().push([device = _device.logical(), pool = _pool]()
+                                 { vkDestroyCommandPool(device, pool, nullptr); });
+}
+
+VkCommandBuffer CommandCache::get(uint32_t slot, const CommandKey &key, const std::function<void(VkCommandBuffer)> &record)
+{
+    if (slot >= _entries.size())
+        _entries.resize(slot + 1);
+
+    Entry &entry = _entries[slot];
+    if (entry.commandBuffer != VK_NULL_HANDLE && entry.key == key)
+    {
+        _hits++;
+        return entry.commandBuffer;
+    }
+
+    _misses++;
+
+    // The outdated buffer may still be executing
+    if (entry.commandBuffer != VK_NULL_HANDLE)
+        _device.deletionQueue().freeCommandBuffers(_pool, {entry.commandBuffer});
+
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = _pool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+    allocInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(_device.logical(), &allocInfo, &entry.commandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate cached command buffer!");
+
+    record(entry.commandBuffer);
+    entry.key = key;
+
+    return entry.commandBuffer;
+}
+
+void CommandCache::clear()
+{
+    for (Entry &entry : _entries)
+        if (entry.commandBuffer != VK_NULL_HANDLE)
+            _device.deletionQueue().freeCommandBuffers(_pool, {entry.commandBuffer});
+
+    _entries.clear();
+}
@@ -0,0 +1,55 @@
+#include <CommandPool.hpp>
+#include <Device.hpp>
+
+CommandPool::CommandPool(const Device &device, uint32_t queueFamily, VkCommandBufferLevel level) : _device(device),
+                                                                                                   _level(level),
+                                                                                                   _used(0)
+{
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    // Buffers are re-recorded every time, and only ever reset along with the whole pool
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+
+    if (vkCreateCommandPool(_device.logical(), &poolInfo, nullptr, &_pool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create command pool!");
+}
+
+CommandPool::~CommandPool()
+{
+    // Frees the command buffers along with it
+    vkDestroyCommandPool(_device.logical(), _pool, nullptr);
+}
+
+VkCommandBuffer CommandPool::acquire()
+{
+    if (_used == _buffers.size())
+    {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = _pool;
+        allocInfo.level = _level;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer;
+        if (vkAllocateCommandBuffers(_device.logical(), &allocInfo, &commandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("failed to allocate command buffer!");
+
+        _buffers.push_back(commandBuffer);
+    }
+
+    return _buffers[_used++];
+}
+
+void CommandPool::reset()
+{
+    // Nothing recorded since the last reset, spare the driver call
+    if (_used == 0)
+        return;
+
+    // Keep the memory : next frame will record about as much
+    if (vkResetCommandPool(_device.logical(), _pool, 0) != VK_SUCCESS)
+        throw std::runtime_error("failed to reset command pool!");
+
+    _used = 0;
+}
@@ -0,0 +1,181 @@
+#include <CpuProfiler.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef VKBULLSHIT_PROFILER
+const bool CpuProfiler::Enabled = true;
+#else
+const bool CpuProfiler::Enabled = false;
+#endif
+const size_t CpuProfiler::ZonesPerThread = 1 << 16;
+const size_t CpuProfiler::FramesKept = 1024;
+
+/// @brief Zones of one thread. Written by that thread only : `head` is the only thing the reader has to agree on
+struct ThreadRing
+{
+    uint32_t id;
+    /// @brief Guarded by the registry's mutex
+    std::string name;
+    std::unique_ptr<CpuProfiler::Zone[]> zones;
+    /// @brief Zones recorded since the thread started, the last ZonesPerThread of which are still in the ring
+    std::atomic<uint64_t> head{0};
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    /// @brief Never freed : a trace may still want the zones of a thread that is gone
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> frameStarts{new std::atomic<uint64_t>[CpuProfiler::FramesKept]};
+    std::atomic<uint64_t> frameCount{0};
+};
+
+static Registry &GetRegistry()
+{
+    // Built on first use : zones may be recorded before main() is
+    static Registry registry;
+    return registry;
+}
+
+static thread_local ThreadRing *CurrentRing = nullptr;
+
+/// @brief Ring of the calling thread, created on its first zone. The only time recording takes a lock
+static ThreadRing &CurrentThreadRing()
+{
+    if (CurrentRing)
+        return *CurrentRing;
+
+    Registry &registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    auto ring = std::make_unique<ThreadRing>();
+    ring->id = static_cast<uint32_t>(registry.rings.size());
+    ring->name = "Thread " + std::to_string(ring->id);
+    ring->zones.reset(new CpuProfiler::Zone[CpuProfiler::ZonesPerThread]);
+
+    CurrentRing = ring.get();
+    registry.rings.push_back(std::move(ring));
+    return *CurrentRing;
+}
+
+void CpuProfiler::Record(const char *name, uint64_t start, uint64_t end)
+{
+    ThreadRing &ring = CurrentThreadRing();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+
+    // Orders the last head published before the slot is overwritten : a reader seeing the new zone also sees the new head.
+    // Free on x86, the stores are plain moves
+    std::atomic_thread_fence(std::memory_order_release);
+
+    Zone &zone = ring.zones[head % ZonesPerThread];
+    zone.name.store(name, std::memory_order_relaxed);
+    zone.start.store(start, std::memory_order_relaxed);
+    zone.end.store(end, std::memory_order_relaxed);
+
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void CpuProfiler::SetThreadName(const char *name)
+{
+    ThreadRing &ring = CurrentThreadRing();
+
+    std::lock_guard lock(GetRegistry().mutex);
+    ring.name = name;
+}
+
+void CpuProfiler::FrameMark()
+{
+    Registry &registry = GetRegistry();
+    uint64_t frame = registry.frameCount.load(std::memory_order_relaxed);
+    registry.frameStarts[frame % FramesKept].store(Now(), std::memory_order_relaxed);
+    registry.frameCount.store(frame + 1, std::memory_order_release);
+}
+
+void CpuProfiler::WriteTrace(const std::string &path, uint32_t frames)
+{
+    struct Event
+    {
+        uint32_t thread;
+        const char *name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    Registry &registry = GetRegistry();
+
+    // Start of the oldest frame asked for. One less than kept : the oldest slot may be being overwritten
+    uint64_t frameCount = registry.frameCount.load(std::memory_order_acquire);
+    uint64_t traced = std::min<uint64_t>({frames, frameCount, FramesKept - 1});
+    uint64_t since = traced == 0 ? 0 : registry.frameStarts[(frameCount - traced) % FramesKept].load(std::memory_order_relaxed);
+
+    std::vector<Event> events;
+    std::vector<std::pair<uint32_t, std::string>> threads;
+    {
+        std::lock_guard lock(registry.mutex);
+        for (const auto &ring : registry.rings)
+        {
+            threads.emplace_back(ring->id, ring->name);
+
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            uint64_t first = head > ZonesPerThread ? head - ZonesPerThread : 0;
+            size_t copied = events.size();
+            for (uint64_t i = first; i < head; i++)
+            {
+                const Zone &zone = ring->zones[i % ZonesPerThread];
+                events.push_back({ring->id, zone.name.load(std::memory_order_relaxed), zone.start.load(std::memory_order_relaxed),
+                                  zone.end.load(std::memory_order_relaxed)});
+            }
+
+            // Whatever the thread overwrote while being copied is torn, and dropped : zone i is intact as long as
+            // zone i + ZonesPerThread wasn't started yet
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t newHead = ring->head.load(std::memory_order_relaxed);
+            uint64_t torn = newHead >= ZonesPerThread ? newHead - ZonesPerThread + 1 : 0;
+            if (torn > first)
+                events.erase(events.begin() + copied, events.begin() + copied + std::min(torn - first, head - first));
+        }
+    }
+
+    events.erase(std::remove_if(events.begin(), events.end(), [since](const Event &event)
+                                { return event.end < since; }),
+                 events.end());
+
+    // Timestamps relative to the start of the trace, so that they keep their precision as doubles. Zones already open when
+    // the oldest frame started are kept whole, so the trace starts with the earliest of them
+    uint64_t origin = since != 0 ? since : UINT64_MAX;
+    for (const Event &event : events)
+        origin = std::min(origin, event.start);
+
+    std::ofstream file(path);
+    if (!file)
+        throw std::runtime_error("failed to open trace file!");
+
+    // Microseconds, with nanosecond precision
+    auto microseconds = [origin](uint64_t time)
+    {
+        return static_cast<double>(static_cast<int64_t>(time - origin)) / 1000.0;
+    };
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n"
+         << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"VkBullshit\"}}";
+
+    for (const auto &[id, name] : threads)
+        file << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << id << ", \"args\": {\"name\": \"" << name << "\"}}";
+
+    for (uint64_t frame = frameCount - traced; frame < frameCount; frame++)
+        file << ",\n  {\"name\": \"Frame " << frame << "\", \"ph\": \"i\", \"s\": \"g\", \"pid\": 1, \"tid\": 0, \"ts\": "
+             << microseconds(registry.frameStarts[frame % FramesKept].load(std::memory_order_relaxed)) << "}";
+
+    for (const Event &event : events)
+        file << ",\n  {\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread
+             << ", \"ts\": " << microseconds(event.start) << ", \"dur\": " << microseconds(event.end) - microseconds(event.start) << "}";
+
+    file << "\n]}\n";
+}
@@ -0,0 +1,116 @@
+#include <DeletionQueue.hpp>
+#include <Device.hpp>
+#include <memory/Allocator.hpp>
+#include <Scheduler.hpp>
+
+DeletionQueue::DeletionQueue(const Device &device) : _device(device)
+{
+}
+
+DeletionQueue::~DeletionQueue()
+{
+    flush();
+}
+
+void DeletionQueue::collect()
+{
+    // Entries are sorted by value, as the timeline only ever goes up
+    while (true)
+    {
+        Entry entry;
+        {
+            std::lock_guard lock(_mutex);
+            if (_entries.empty() || !_device.scheduler().reached(QueueType::Graphics, _entries.front().value))
+                return;
+            entry = std::move(_entries.front());
+            _entries.pop_front();
+        }
+
+        // Outside the lock : destroying may push something else
+        entry.destroy();
+    }
+}
+
+void DeletionQueue::flush()
+{
+    while (true)
+    {
+        Entry entry;
+        {
+            std::lock_guard lock(_mutex);
+            if (_entries.empty())
+                return;
+            entry = std::move(_entries.front());
+            _entries.pop_front();
+        }
+
+        entry.destroy();
+    }
+}
+
+void DeletionQueue::push(std::function<void()> destroy)
+{
+    // The object may be used by what is being recorded right now, so it has to outlive the next submission too
+    std::lock_guard lock(_mutex);
+    _entries.push_back({_device.scheduler().timeline(QueueType::Graphics).pending() + 1, std::move(destroy)});
+}
+
+void DeletionQueue::destroyBuffer(const Buffer &buffer)
+{
+    push([this, buffer = Buffer(buffer)]() mutable
+         { _device.allocator().destroyBuffer(buffer); });
+}
+
+void DeletionQueue::destroyImage(const Image &image)
+{
+    push([this, image = Image(image)]() mutable
+         { _device.allocator().destroyImage(image); });
+}
+
+void DeletionQueue::destroyImageView(VkImageView imageView)
+{
+    push([this, imageView]()
+         { vkDestroyImageView(_device.logical(), imageView, nullptr); });
+}
+
+void DeletionQueue::destroyFramebuffer(VkFramebuffer framebuffer)
+{
+    push([this, framebuffer]()
+         { vkDestroyFramebuffer(_device.logical(), framebuffer, nullptr); });
+}
+
+void DeletionQueue::destroyRenderPass(VkRenderPass renderPass)
+{
+    push([this, renderPass]()
+         { vkDestroyRenderPass(_device.logical(), renderPass, nullptr); });
+}
+
+void DeletionQueue::destroyPipeline(VkPipeline pipeline)
+{
+    push([this, pipeline]()
+         { vkDestroyPipeline(_device.logical(), pipeline, nullptr); });
+}
+
+void DeletionQueue::destroyPipelineLayout(VkPipelineLayout layout)
+{
+    push([this, layout]()
+         { vkDestroyPipelineLayout(_device.logical(), layout, nullptr); });
+}
+
+void DeletionQueue::destroySwapChain(VkSwapchainKHR swapChain)
+{
+    push([this, swapChain]()
+         { vkDestroySwapchainKHR(_device.logical(), swapChain, nullptr); });
+}
+
+void DeletionQueue::destroySemaphore(VkSemaphore semaphore)
+{
+    push([this, semaphore]()
+         { vkDestroySemaphore(_device.logical(), semaphore, nullptr); });
+}
+
+void DeletionQueue::freeCommandBuffers(VkCommandPool pool, std::vector<VkCommandBuffer> commandBuffers)
+{
+    push([this, pool, commandBuffers]()
+         { vkFreeCommandBuffers(_device.logical(), pool, static_cast<uint32_t>(commandBuffers.size()), commandBuffers.data()); });
+}
@@ -2,8 +2,15 @@
 #include <Window.hpp>
 #include <QueueFamily.hpp>
 #include <SwapChain.hpp>
+#include <memory/Allocator.hpp>
+#include <memory/MemoryTypes.hpp>
+#include <memory/Uploader.hpp>
+#include <memory/MemoryBudget.hpp>
+#include <DeletionQueue.hpp>
+#include <Scheduler.hpp>
 
 #include <set>
+#include <cstring>
 
 void Device::pickPhysicalDevice()
 {
@@ -34,15 +41,22 @@ void Device::pickPhysicalDevice()
     }
 }
 
-Device::Device(const Window &window) : _window(window), _physical(VK_NULL_HANDLE), _logical(VK_NULL_HANDLE), _presentQueue(VK_NULL_HANDLE), _graphicsQueue(VK_NULL_HANDLE)
+Device::Device(const Window &window) : _window(window), _physical(VK_NULL_HANDLE), _logical(VK_NULL_HANDLE), _presentQueue(VK_NULL_HANDLE), _graphicsQueue(VK_NULL_HANDLE), _transferQueue(VK_NULL_HANDLE), _memoryBudgetEnabled(false), _dynamicRenderingEnabled(false), _presentWaitEnabled(false), _pipelineStatisticsEnabled(false), _timestampPeriod(0.0f), _timestampMask(0), _cmdBeginRendering(nullptr), _cmdEndRendering(nullptr), _waitForPresent(nullptr)
 {
     pickPhysicalDevice();
 
     _indices = QueueFamily(_physical, _window.surface());
+    // Memory properties never change, query them once and for all
+    _memoryTypes = std::make_unique<MemoryTypeTable>(_physical);
+    queryTimestampSupport();
 
     // Setup queue families for device
     std::set<uint32_t> uniqueQueueFamilies = {_indices.graphicsFamily.value(),
                                               _indices.presentFamily.value()};
+
+    // Uploads go through a DMA queue when there is one, the graphics queue otherwise
+    _transferFamily = _indices.transferFamily.value_or(_indices.graphicsFamily.value());
+    uniqueQueueFamilies.insert(_transferFamily);
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
 
     float priority = 1.0f;
@@ -58,9 +72,32 @@ Device::Device(const Window &window) : _window(window), _physical(VK_NULL_HANDLE
 
     VkPhysicalDeviceFeatures deviceFeatures = {};
 
+    // Optional, only the pipeline statistics need it
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(_physical, &supportedFeatures);
+    _pipelineStatisticsEnabled = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
+    deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+
+    // Only chained when the extension gets enabled
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {};
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+    presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    presentIdFeatures.presentId = VK_TRUE;
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+    presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+    presentWaitFeatures.presentWait = VK_TRUE;
+
     // Setup logical device
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &vulkan12Features;
 
     createInfo.queueCreateInfoCount =
         static_cast<uint32_t>(queueCreateInfos.size());
@@ -68,9 +105,33 @@ Device::Device(const Window &window) : _window(window), _physical(VK_NULL_HANDLE
 
     createInfo.pEnabledFeatures = &deviceFeatures;
 
-    // Manage GLFW extensions
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(Window::DeviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = Window::DeviceExtensions.data();
+    // Required extensions, then the optional ones we can make use of
+    _enabledExtensions.assign(Window::DeviceExtensions.begin(), Window::DeviceExtensions.end());
+    // The budget is read through vkGetPhysicalDeviceMemoryProperties2, core since 1.1
+    _memoryBudgetEnabled = enableOptionalExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME, VK_API_VERSION_1_1);
+    // Rendering straight to image views, without render pass or framebuffer objects. Core in 1.3, but the instance is 1.2
+    _dynamicRenderingEnabled = checkDynamicRenderingSupport(_physical) && enableOptionalExtension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME, VK_API_VERSION_1_2);
+    // Waiting for a given present to be on screen, for the latency limiter. Needs both, present_wait relies on the present ids
+    _presentWaitEnabled = checkPresentWaitSupport(_physical) &&
+                          enableOptionalExtension(VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+                          enableOptionalExtension(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+
+    // Feature structs of the optional extensions, chained after the 1.2 ones
+    void **next = &vulkan12Features.pNext;
+    if (_dynamicRenderingEnabled)
+    {
+        *next = &dynamicRenderingFeatures;
+        next = &dynamicRenderingFeatures.pNext;
+    }
+    if (_presentWaitEnabled)
+    {
+        *next = &presentIdFeatures;
+        presentIdFeatures.pNext = &presentWaitFeatures;
+        next = &presentWaitFeatures.pNext;
+    }
+
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(_enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = _enabledExtensions.data();
 
     if (_window.enabledValidationLayers())
     {
@@ -94,6 +155,53 @@ Device::Device(const Window &window) : _window(window), _physical(VK_NULL_HANDLE
                      &_graphicsQueue);
     vkGetDeviceQueue(_logical, _indices.presentFamily.value(), 0,
                      &_presentQueue);
+    vkGetDeviceQueue(_logical, _transferFamily, 0, &_transferQueue);
+
+    // Extension commands aren't exported by the loader
+    if (_dynamicRenderingEnabled)
+    {
+        _cmdBeginRendering = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(vkGetDeviceProcAddr(_logical, "vkCmdBeginRenderingKHR"));
+        _cmdEndRendering = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(vkGetDeviceProcAddr(_logical, "vkCmdEndRenderingKHR"));
+    }
+    if (_presentWaitEnabled)
+        _waitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(_logical, "vkWaitForPresentKHR"));
+
+    _scheduler = std::make_unique<Scheduler>(*this);
+    _allocator = std::make_unique<Allocator>(*this);
+    _uploader = std::make_unique<Uploader>(*this);
+    _budget = std::make_unique<MemoryBudget>(*this, _memoryBudgetEnabled);
+    _deletionQueue = std::make_unique<DeletionQueue>(*this);
+}
+
+void Device::queryTimestampSupport()
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(_physical, &properties);
+
+    uint32_t familyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(_physical, &familyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> families(familyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(_physical, &familyCount, families.data());
+
+    // Frames are timed on the graphics queue only
+    uint32_t validBits = families[_indices.graphicsFamily.value()].timestampValidBits;
+    if (validBits == 0)
+        return;
+
+    _timestampPeriod = properties.limits.timestampPeriod;
+    _timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+}
+
+Device::~Device()
+{
+    // Every block must go back to the driver before the device itself is gone
+    // Deferred destructions may still hold buffers
+    _deletionQueue.reset();
+    _budget.reset();
+    _uploader.reset();
+    _allocator.reset();
+    _scheduler.reset();
+    vkDestroyDevice(_logical, nullptr);
 }
 
 bool Device::isDeviceSuitable(const VkPhysicalDevice &device)
@@ -109,7 +217,79 @@ bool Device::isDeviceSuitable(const VkPhysicalDevice &device)
         swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
     }
 
-    return indices.isComplete() && extensionsSupported && swapChainAdequate;
+    return indices.isComplete() && extensionsSupported && swapChainAdequate && checkTimelineSupport(device);
+}
+
+bool Device::checkTimelineSupport(const VkPhysicalDevice &device)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+    if (properties.apiVersion < VK_API_VERSION_1_2)
+        return false;
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 features = {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &vulkan12Features;
+    vkGetPhysicalDeviceFeatures2(device, &features);
+
+    return vulkan12Features.timelineSemaphore == VK_TRUE;
+}
+
+bool Device::checkDynamicRenderingSupport(const VkPhysicalDevice &device)
+{
+    // The features struct may only be chained when the extension exists
+    if (!hasExtension(device, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME))
+        return false;
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures = {};
+    dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+
+    VkPhysicalDeviceFeatures2 features = {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &dynamicRenderingFeatures;
+    vkGetPhysicalDeviceFeatures2(device, &features);
+
+    return dynamicRenderingFeatures.dynamicRendering == VK_TRUE;
+}
+
+bool Device::checkPresentWaitSupport(const VkPhysicalDevice &device)
+{
+    if (!hasExtension(device, VK_KHR_PRESENT_ID_EXTENSION_NAME) || !hasExtension(device, VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+        return false;
+
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+    presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+    presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+    presentIdFeatures.pNext = &presentWaitFeatures;
+
+    VkPhysicalDeviceFeatures2 features = {};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &presentIdFeatures;
+    vkGetPhysicalDeviceFeatures2(device, &features);
+
+    return presentIdFeatures.presentId == VK_TRUE && presentWaitFeatures.presentWait == VK_TRUE;
+}
+
+bool Device::hasExtension(const VkPhysicalDevice &device, const char *name)
+{
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto &extension : availableExtensions)
+    {
+        if (strcmp(extension.extensionName, name) == 0)
+            return true;
+    }
+
+    return false;
 }
 
 bool Device::checkDeviceExtensionSupport(const VkPhysicalDevice &device)
@@ -128,4 +308,15 @@ bool Device::checkDeviceExtensionSupport(const VkPhysicalDevice &device)
     }
 
     return requiredExtensions.empty();
+}
+
+bool Device::enableOptionalExtension(const char *name, uint32_t minApiVersion)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(_physical, &properties);
+    if (properties.apiVersion < minApiVersion || !hasExtension(_physical, name))
+        return false;
+
+    _enabledExtensions.push_back(name);
+    return true;
 }
\ No newline at end of file
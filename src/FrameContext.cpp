@@ -0,0 +1,48 @@
+#include <FrameContext.hpp>
+#include <Device.hpp>
+#include <Scheduler.hpp>
+
+#include <algorithm>
+
+const uint32_t FrameContext::MaxFramesInFlight = 3;
+
+FrameContext::FrameContext(const Device &device, uint32_t recordingThreads, VkDeviceSize ringCapacity) : _device(device),
+                                                                                                          _commandPool(device, device.queueFamilyIndices().graphicsFamily.value()),
+                                                                                                          _submission(0),
+                                                                                                          _ring(device, ringCapacity),
+                                                                                                          _frameNumber(0)
+{
+    for (uint32_t thread = 0; thread < std::max(recordingThreads, 1u); thread++)
+        _secondaryPools.push_back(std::make_unique<CommandPool>(device, device.queueFamilyIndices().graphicsFamily.value(), VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    if (vkCreateSemaphore(_device.logical(), &semaphoreInfo, nullptr, &_imageAvailable) != VK_SUCCESS)
+        throw std::runtime_error("failed to create synchronization objects for a frame!");
+}
+
+FrameContext::~FrameContext()
+{
+    vkDestroySemaphore(_device.logical(), _imageAvailable, nullptr);
+}
+
+void FrameContext::wait() const
+{
+    // Value 0 is reached from the start, so a context that never submitted doesn't block
+    _device.scheduler().timeline(QueueType::Graphics).wait(_submission);
+}
+
+bool FrameContext::done() const
+{
+    return _device.scheduler().reached(QueueType::Graphics, _submission);
+}
+
+void FrameContext::begin(uint64_t frameNumber)
+{
+    _frameNumber = frameNumber;
+    _ring.begin();
+    _commandPool.reset();
+    for (auto &pool : _secondaryPools)
+        pool->reset();
+}
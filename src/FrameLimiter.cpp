@@ -0,0 +1,41 @@
+#include <FrameLimiter.hpp>
+
+#include <thread>
+
+const FrameLimiter::Clock::duration FrameLimiter::SpinMargin = std::chrono::microseconds(1500);
+
+FrameLimiter::FrameLimiter() : _period(Clock::duration::zero()),
+                               _deadline(Clock::now())
+{
+}
+
+void FrameLimiter::setTargetFps(uint32_t fps)
+{
+    Clock::duration period = fps == 0 ? Clock::duration::zero() : std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / fps;
+    if (period == _period)
+        return;
+
+    _period = period;
+    _deadline = Clock::now();
+}
+
+void FrameLimiter::wait()
+{
+    if (!capped())
+        return;
+
+    _deadline += _period;
+    Clock::time_point now = Clock::now();
+
+    // More than a frame late (hitch, breakpoint...) : start over from now rather than rushing to catch up
+    if (now > _deadline + _period)
+    {
+        _deadline = now;
+        return;
+    }
+
+    if (_deadline - now > SpinMargin)
+        std::this_thread::sleep_until(_deadline - SpinMargin);
+    while (Clock::now() < _deadline)
+        std::this_thread::yield();
+}
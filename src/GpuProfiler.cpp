@@ -0,0 +1,105 @@
+#include <GpuProfiler.hpp>
+#include <Device.hpp>
+
+const uint32_t GpuProfiler::MaxScopes = 32;
+const size_t GpuProfiler::HistoryLength = 240;
+
+GpuProfiler::GpuProfiler(const Device &device) : _device(device),
+                                                 _current(nullptr),
+                                                 _history(HistoryLength)
+{
+    if (!_device.timestampsSupported())
+        return;
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = MaxScopes * 2;
+
+    _ring = std::make_unique<QueryRing>(_device, queryPoolInfo, 1);
+    _scopes.resize(QueryRing::FrameLatency);
+    for (std::vector<Scope> &scopes : _scopes)
+        scopes.reserve(MaxScopes);
+}
+
+GpuProfiler::~GpuProfiler() = default;
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint64_t frameNumber)
+{
+    if (!enabled())
+        return;
+
+    _current = &_scopes[_ring->beginFrame(commandBuffer, frameNumber)];
+    _current->clear();
+    _open.clear();
+
+    begin(commandBuffer, "Frame");
+}
+
+void GpuProfiler::endFrame(VkCommandBuffer commandBuffer)
+{
+    if (!_current)
+        return;
+
+    while (!_open.empty())
+        end(commandBuffer);
+
+    _ring->endFrame(static_cast<uint32_t>(_current->size()) * 2);
+    _current = nullptr;
+}
+
+void GpuProfiler::begin(VkCommandBuffer commandBuffer, const char *name)
+{
+    if (!_current)
+        return;
+
+    // Out of queries : the scope is left out, but still has to be matched by its end()
+    uint32_t scope = static_cast<uint32_t>(_current->size());
+    if (scope >= MaxScopes)
+    {
+        _open.push_back(MaxScopes);
+        return;
+    }
+
+    _current->push_back({name, static_cast<uint32_t>(_open.size())});
+    _open.push_back(scope);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _ring->pool(), scope * 2);
+}
+
+void GpuProfiler::end(VkCommandBuffer commandBuffer)
+{
+    if (!_current || _open.empty())
+        return;
+
+    uint32_t scope = _open.back();
+    _open.pop_back();
+    if (scope < MaxScopes)
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _ring->pool(), scope * 2 + 1);
+}
+
+std::vector<GpuFrameResult> GpuProfiler::collect()
+{
+    std::vector<GpuFrameResult> results;
+    if (!enabled())
+        return results;
+
+    _ring->collect([this, &results](uint32_t slot, uint64_t frameNumber, const uint64_t *ticks, uint32_t queryCount)
+                   {
+                       const std::vector<Scope> &scopes = _scopes[slot];
+                       GpuFrameResult &result = results.emplace_back();
+                       result.frameNumber = frameNumber;
+                       for (size_t i = 0; i < scopes.size(); i++)
+                       {
+                           // Only the valid bits wrap around
+                           uint64_t elapsed = (ticks[i * 2 + 1] - ticks[i * 2]) & _device.timestampMask();
+                           result.scopes.push_back({scopes[i].name, scopes[i].depth, static_cast<double>(elapsed) * _device.timestampPeriod() / 1e6});
+                       } });
+
+    _history.push(results);
+    return results;
+}
+
+std::vector<GpuFrameResult> GpuProfiler::history() const
+{
+    return _history.copy();
+}
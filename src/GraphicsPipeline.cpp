@@ -8,11 +8,12 @@
 #include <RenderPass.hpp>
 #include <geometry/Vertex.hpp>
 
-GraphicsPipeline::GraphicsPipeline(const Device &device, const SwapChain &swapChain, const RenderPass &renderPass, const std::vector<ShaderInfo> shaders) : _oldLayout(VK_NULL_HANDLE),
-                                                                                                                                                            _device(device),
-                                                                                                                                                            _swapChain(swapChain),
-                                                                                                                                                            _renderPass(renderPass),
-                                                                                                                                                            _shaders(shaders)
+GraphicsPipeline::GraphicsPipeline(const Device &device, const SwapChain &swapChain, const RenderPass &renderPass, const std::vector<ShaderInfo> shaders, VertexInputDescription vertexInput) : _oldLayout(VK_NULL_HANDLE),
+                                                                                                                                                                                                _device(device),
+                                                                                                                                                                                                _swapChain(swapChain),
+                                                                                                                                                                                                _renderPass(renderPass),
+                                                                                                                                                                                                _shaders(shaders),
+                                                                                                                                                                                                _vertexInput(std::move(vertexInput))
 {
     createPipeline();
 }
@@ -23,10 +24,6 @@ GraphicsPipeline::~GraphicsPipeline()
     vkDestroyPipelineLayout(_device.logical(), _layout, nullptr);
 }
 
-void GraphicsPipeline::recreate()
-{
-}
-
 void GraphicsPipeline::createPipeline()
 {
     std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
@@ -60,14 +57,11 @@ void GraphicsPipeline::createPipeline()
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-    // Fetch vertex shader binding info
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
-
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+    // Vertex shader binding info, generated from the vertex layout
+    vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(_vertexInput.bindings.size());
+    vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(_vertexInput.attributes.size());
+    vertexInputInfo.pVertexBindingDescriptions = _vertexInput.bindings.data();
+    vertexInputInfo.pVertexAttributeDescriptions = _vertexInput.attributes.data();
 
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
     inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -196,6 +190,19 @@ void GraphicsPipeline::createPipeline()
     // Integrate render pass, using subpass with id=0 for render
     pipelineInfo.renderPass = _renderPass.handle();
     pipelineInfo.subpass = 0;
+
+    // Dynamic rendering : no render pass, only the formats of the attachments drawn to
+    VkFormat colorFormat = _renderPass.colorFormat();
+    VkPipelineRenderingCreateInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &colorFormat;
+
+    if (_renderPass.dynamic())
+    {
+        pipelineInfo.pNext = &renderingInfo;
+        pipelineInfo.renderPass = VK_NULL_HANDLE;
+    }
     // May be useful for derived pipelines, instead of re-creating
     // everything for a slightly different pipeline.
     // Optional.
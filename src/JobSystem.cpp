@@ -0,0 +1,215 @@
+#include <JobSystem.hpp>
+#include <CpuProfiler.hpp>
+
+#include <algorithm>
+
+const uint32_t JobSystem::AutoWorkers = UINT32_MAX;
+
+// Threads not created by the job system count as thread 0 (the main one), unless adopted
+static thread_local uint32_t CurrentThread = 0;
+
+JobSystem::JobSystem(uint32_t workerCount, uint32_t adoptedThreads) : _adoptedThreads(adoptedThreads),
+                                                                      _queued(0),
+                                                                      _sleeping(0),
+                                                                      _stopping(false)
+{
+    if (workerCount == AutoWorkers)
+        workerCount = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+
+    // All deques exist before any worker starts looking at them
+    for (uint32_t thread = 0; thread <= workerCount + adoptedThreads; thread++)
+        _queues.push_back(std::make_unique<WorkQueue>());
+
+    for (uint32_t thread = 1; thread <= workerCount; thread++)
+        _workers.emplace_back(&JobSystem::workerLoop, this, thread);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard lock(_sleepMutex);
+        _stopping = true;
+    }
+    _wake.notify_all();
+
+    for (std::thread &worker : _workers)
+        worker.join();
+}
+
+void JobSystem::adoptThread(uint32_t slot)
+{
+    if (slot >= _adoptedThreads)
+        throw std::runtime_error("no job system slot left for this thread!");
+
+    CurrentThread = threadCount() - _adoptedThreads + slot;
+}
+
+uint32_t JobSystem::ThreadIndex()
+{
+    return CurrentThread;
+}
+
+void JobSystem::run(Job job, JobCounter *counter)
+{
+    if (counter)
+        counter->_pending.fetch_add(1, std::memory_order_relaxed);
+
+    push(*_queues[CurrentThread], {std::move(job), counter});
+}
+
+void JobSystem::runOnMain(Job job, JobCounter *counter)
+{
+    if (counter)
+        counter->_pending.fetch_add(1, std::memory_order_relaxed);
+
+    // Not counted in _queued : workers can't do anything about it anyway
+    std::lock_guard lock(_mainQueue.mutex);
+    _mainQueue.tasks.push_back({std::move(job), counter});
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t first, size_t last)> &body)
+{
+    grain = std::max<size_t>(grain, 1);
+
+    JobCounter counter;
+    for (size_t first = 0; first < count; first += grain)
+    {
+        size_t last = std::min(first + grain, count);
+        run([&body, first, last]
+            { body(first, last); },
+            &counter);
+    }
+
+    wait(counter);
+}
+
+void JobSystem::push(WorkQueue &queue, Task task)
+{
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+
+    _queued.fetch_add(1);
+
+    // Going through the mutex makes sure a worker about to sleep either sees the job or gets the notification
+    if (_sleeping.load() > 0)
+    {
+        {
+            std::lock_guard lock(_sleepMutex);
+        }
+        _wake.notify_one();
+    }
+}
+
+bool JobSystem::runOne(uint32_t thread)
+{
+    Task task;
+    bool found = false;
+
+    // Own deque first, newest job first : its data is most likely still in cache
+    {
+        WorkQueue &own = *_queues[thread];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+
+    // Then steal the oldest job of someone else, starting with the next thread so that thieves spread out
+    for (uint32_t i = 1; !found && i < _queues.size(); i++)
+    {
+        WorkQueue &victim = *_queues[(thread + i) % _queues.size()];
+        std::unique_lock lock(victim.mutex, std::try_to_lock);
+        if (lock.owns_lock() && !victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+
+    if (!found)
+        return false;
+
+    _queued.fetch_sub(1);
+    CPU_ZONE("Job");
+    Execute(task);
+    return true;
+}
+
+void JobSystem::Execute(Task &task)
+{
+    try
+    {
+        task.job();
+    }
+    catch (...)
+    {
+        // Nobody to hand the error to : same as an exception escaping a thread
+        if (!task.counter)
+            throw;
+
+        if (!task.counter->_failed.exchange(true))
+            task.counter->_error = std::current_exception();
+    }
+
+    if (task.counter)
+        task.counter->_pending.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::wait(const JobCounter &counter)
+{
+    uint32_t thread = CurrentThread;
+    while (!counter.done())
+    {
+        if (thread == 0)
+            pumpMain();
+
+        // Help instead of blocking. Nothing to help with : the remaining jobs are running elsewhere
+        if (!runOne(thread))
+            std::this_thread::yield();
+    }
+
+    if (counter._error)
+        std::rethrow_exception(counter._error);
+}
+
+void JobSystem::pumpMain()
+{
+    while (true)
+    {
+        Task task;
+        {
+            std::lock_guard lock(_mainQueue.mutex);
+            if (_mainQueue.tasks.empty())
+                return;
+            task = std::move(_mainQueue.tasks.front());
+            _mainQueue.tasks.pop_front();
+        }
+
+        Execute(task);
+    }
+}
+
+void JobSystem::workerLoop(uint32_t thread)
+{
+    CurrentThread = thread;
+    CPU_THREAD_NAME(("Worker " + std::to_string(thread)).c_str());
+
+    while (!_stopping)
+    {
+        if (runOne(thread))
+            continue;
+
+        // A steal may have failed on a busy lock : only sleep once nothing is queued at all
+        std::unique_lock lock(_sleepMutex);
+        _sleeping.fetch_add(1);
+        _wake.wait(lock, [this]
+                   { return _stopping || _queued.load() > 0; });
+        _sleeping.fetch_sub(1);
+    }
+}
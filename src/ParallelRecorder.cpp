@@ -0,0 +1,123 @@
+#include <ParallelRecorder.hpp>
+#include <Renderer.hpp>
+#include <RenderPass.hpp>
+#include <FrameContext.hpp>
+#include <CommandPool.hpp>
+#include <JobSystem.hpp>
+#include <PipelineStatistics.hpp>
+#include <CpuProfiler.hpp>
+
+#include <algorithm>
+
+const size_t ParallelRecorder::MinDrawsPerChunk = 256;
+const uint32_t ParallelRecorder::ChunksPerThread = 2;
+
+ParallelRecorder::ParallelRecorder(const Device &device, JobSystem &jobs) : _device(device),
+                                                                           _jobs(jobs)
+{
+}
+
+void ParallelRecorder::record(FrameContext &frame, const RenderPass &renderPass, uint32_t subpass, uint32_t imageIndex,
+                              std::span<Renderer *const> renderers, std::span<const DrawState> states, JobCounter &counter, PipelineStatistics *statistics, const char *pass)
+{
+    _commandBuffers.clear();
+
+    size_t chunkCount = std::min<size_t>(_jobs.threadCount() * ChunksPerThread, renderers.size() / MinDrawsPerChunk);
+
+    // Small list : not worth a job, and each renderer can replay its cached buffer
+    if (chunkCount <= 1)
+    {
+        for (size_t i = 0; i < renderers.size(); i++)
+            _commandBuffers.push_back(renderers[i]->secondary(frame, subpass, imageIndex, states[i], statistics, pass));
+        return;
+    }
+
+    _commandBuffers.resize(chunkCount, VK_NULL_HANDLE);
+    size_t chunkSize = (renderers.size() + chunkCount - 1) / chunkCount;
+
+    // Created here rather than by the jobs, which only ever touch their own
+    while (_chunks.size() < chunkCount)
+        _chunks.push_back(std::make_unique<Chunk>(_device));
+
+    // A cached buffer would point to the queries of the frame it was recorded for
+    bool counted = statistics && statistics->recording();
+
+    for (size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        size_t first = chunk * chunkSize;
+        size_t last = std::min(first + chunkSize, renderers.size());
+
+        _jobs.run([this, &frame, &renderPass, subpass, imageIndex, renderers, states, chunk, first, last, counted, statistics, pass]
+                  {
+                      CPU_ZONE("RecordChunk");
+                      std::span<Renderer *const> members = renderers.subspan(first, last - first);
+                      std::span<const DrawState> memberStates = states.subspan(first, last - first);
+                      bool cacheable = !counted;
+                      for (size_t i = 0; cacheable && i < members.size(); i++)
+                          cacheable = members[i]->cacheable(memberStates[i]);
+                      if (cacheable)
+                      {
+                          _commandBuffers[chunk] = recordCached(*_chunks[chunk], frame, renderPass, subpass, imageIndex, members, memberStates);
+                          return;
+                      }
+
+                      // Whichever thread runs the chunk records it with its own pool
+                      VkCommandBuffer commandBuffer = frame.secondaryPool(JobSystem::ThreadIndex()).acquire();
+                      renderPass.beginSecondary(commandBuffer, subpass, imageIndex, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+                      uint32_t query = statistics ? statistics->begin(commandBuffer, pass) : PipelineStatistics::NoQuery;
+
+                      for (size_t i = first; i < last; i++)
+                          renderers[i]->record(commandBuffer, frame, states[i]);
+
+                      if (statistics)
+                          statistics->end(commandBuffer, query);
+
+                      if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+                          throw std::runtime_error("failed to record secondary command buffer!");
+
+                      _commandBuffers[chunk] = commandBuffer; },
+                  &counter);
+    }
+}
+
+VkCommandBuffer ParallelRecorder::recordCached(Chunk &chunk, FrameContext &frame, const RenderPass &renderPass, uint32_t subpass,
+                                               uint32_t imageIndex, std::span<Renderer *const> renderers, std::span<const DrawState> states)
+{
+    // With dynamic rendering, one buffer serves every image
+    VkFramebuffer framebuffer = renderPass.target(imageIndex);
+    uint32_t slot = framebuffer != VK_NULL_HANDLE ? imageIndex : 0;
+    if (slot >= chunk.members.size())
+    {
+        chunk.members.resize(slot + 1);
+        chunk.versions.resize(slot + 1, 0);
+    }
+
+    // A renderer added, removed, moved to another chunk or changed : the whole chunk is recorded again
+    std::vector<std::pair<uint64_t, CommandKey>> &members = chunk.members[slot];
+    bool changed = members.size() != renderers.size();
+    for (size_t i = 0; !changed && i < renderers.size(); i++)
+        changed = members[i].first != renderers[i]->id() || !(members[i].second == renderers[i]->cacheKey(imageIndex, states[i]));
+
+    if (changed)
+    {
+        members.clear();
+        for (size_t i = 0; i < renderers.size(); i++)
+            members.emplace_back(renderers[i]->id(), renderers[i]->cacheKey(imageIndex, states[i]));
+        chunk.versions[slot]++;
+    }
+
+    // The members' keys already cover the pipelines and the extent
+    CommandKey key;
+    key.framebuffer = framebuffer;
+    key.generation = renderPass.generation();
+    key.version = chunk.versions[slot];
+
+    return chunk.cache.get(slot, key, [&](VkCommandBuffer commandBuffer)
+                           {
+                               // Replayed by several frames in flight at once
+                               renderPass.beginSecondary(commandBuffer, subpass, imageIndex, VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
+                               for (size_t i = 0; i < renderers.size(); i++)
+                                   renderers[i]->record(commandBuffer, frame, states[i]);
+                               if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+                                   throw std::runtime_error("failed to record cached command buffer!"); });
+}
@@ -0,0 +1,125 @@
+#include <PipelineStatistics.hpp>
+#include <Device.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+const uint32_t PipelineStatistics::MaxQueries = 512;
+const size_t PipelineStatistics::HistoryLength = 240;
+// Written in the order of the bits
+const VkQueryPipelineStatisticFlags PipelineStatistics::Counters = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+                                                                   VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                                                   VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+                                                                   VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                                                                   VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+const uint32_t PipelineStatistics::NoQuery = UINT32_MAX;
+
+// Values written per query, one per bit of Counters
+static const uint32_t CounterCount = 5;
+
+PipelineStatistics::PipelineStatistics(const Device &device) : _device(device),
+                                                               _current(nullptr),
+                                                               _used(0),
+                                                               _active(false),
+                                                               _history(HistoryLength)
+{
+    if (!_device.pipelineStatisticsEnabled())
+        return;
+
+    VkQueryPoolCreateInfo queryPoolInfo{};
+    queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    queryPoolInfo.queryCount = MaxQueries;
+    queryPoolInfo.pipelineStatistics = Counters;
+
+    _ring = std::make_unique<QueryRing>(_device, queryPoolInfo, CounterCount);
+    _passes.resize(QueryRing::FrameLatency, std::vector<const char *>(MaxQueries));
+}
+
+PipelineStatistics::~PipelineStatistics() = default;
+
+void PipelineStatistics::setActive(bool active)
+{
+    _active = active && supported();
+}
+
+void PipelineStatistics::beginFrame(VkCommandBuffer commandBuffer, uint64_t frameNumber)
+{
+    if (!_active)
+        return;
+
+    _current = &_passes[_ring->beginFrame(commandBuffer, frameNumber)];
+    _used.store(0, std::memory_order_relaxed);
+}
+
+void PipelineStatistics::endFrame()
+{
+    if (!_current)
+        return;
+
+    _ring->endFrame(_used.load(std::memory_order_relaxed));
+    _current = nullptr;
+}
+
+uint32_t PipelineStatistics::begin(VkCommandBuffer commandBuffer, const char *pass)
+{
+    if (!_current)
+        return NoQuery;
+
+    // Out of queries : the buffer isn't counted
+    uint32_t query = _used.fetch_add(1, std::memory_order_relaxed);
+    if (query >= MaxQueries)
+        return NoQuery;
+
+    (*_current)[query] = pass;
+    vkCmdBeginQuery(commandBuffer, _ring->pool(), query, 0);
+    return query;
+}
+
+void PipelineStatistics::end(VkCommandBuffer commandBuffer, uint32_t query)
+{
+    if (query != NoQuery)
+        vkCmdEndQuery(commandBuffer, _ring->pool(), query);
+}
+
+std::vector<FrameStatistics> PipelineStatistics::collect()
+{
+    std::vector<FrameStatistics> results;
+    if (!supported())
+        return results;
+
+    _ring->collect([this, &results](uint32_t slot, uint64_t frameNumber, const uint64_t *values, uint32_t queryCount)
+                   {
+                       FrameStatistics &result = results.emplace_back();
+                       result.frameNumber = frameNumber;
+                       for (uint32_t query = 0; query < queryCount; query++)
+                       {
+                           const char *name = _passes[slot][query];
+                           auto pass = std::find_if(result.passes.begin(), result.passes.end(), [name](const PassStatistics &pass)
+                                                    { return strcmp(pass.name, name) == 0; });
+                           if (pass == result.passes.end())
+                           {
+                               pass = result.passes.insert(result.passes.end(), PassStatistics{});
+                               pass->name = name;
+                           }
+
+                           const uint64_t *counters = &values[query * CounterCount];
+                           pass->inputVertices += counters[0];
+                           pass->vertexInvocations += counters[1];
+                           pass->clippingInvocations += counters[2];
+                           pass->clippingPrimitives += counters[3];
+                           pass->fragmentInvocations += counters[4];
+                       }
+
+                       // Buffers of different passes are recorded at the same time, on different threads
+                       std::sort(result.passes.begin(), result.passes.end(), [](const PassStatistics &a, const PassStatistics &b)
+                                 { return strcmp(a.name, b.name) < 0; }); });
+
+    _history.push(results);
+    return results;
+}
+
+std::vector<FrameStatistics> PipelineStatistics::history() const
+{
+    return _history.copy();
+}
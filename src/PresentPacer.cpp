@@ -0,0 +1,55 @@
+#include <PresentPacer.hpp>
+#include <Device.hpp>
+#include <SwapChain.hpp>
+
+const uint64_t PresentPacer::Timeout = 100'000'000;
+
+PresentPacer::PresentPacer(const Device &device, const SwapChain &swapChain) : _device(device),
+                                                                               _swapChain(swapChain),
+                                                                               _maxQueuedFrames(1),
+                                                                               _lastId(0),
+                                                                               _firstId(1),
+                                                                               _presented(VK_NULL_HANDLE),
+                                                                               _presentId{}
+{
+}
+
+bool PresentPacer::enabled() const
+{
+    return _device.presentWaitEnabled() && _maxQueuedFrames > 0;
+}
+
+void PresentPacer::attach(VkPresentInfoKHR &presentInfo)
+{
+    if (!_device.presentWaitEnabled())
+        return;
+
+    // New swapchain : only ids from here on can be waited for
+    if (_swapChain.handle() != _presented)
+    {
+        _presented = _swapChain.handle();
+        _firstId = _lastId + 1;
+    }
+
+    _lastId++;
+
+    _presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+    _presentId.pNext = presentInfo.pNext;
+    _presentId.swapchainCount = 1;
+    _presentId.pPresentIds = &_lastId;
+    presentInfo.pNext = &_presentId;
+}
+
+void PresentPacer::wait()
+{
+    if (!enabled() || _presented != _swapChain.handle())
+        return;
+
+    // The next present will be _lastId + 1 : it may only be preceded by `_maxQueuedFrames - 1` unfinished ones
+    if (_lastId + 1 < _firstId + _maxQueuedFrames)
+        return;
+    uint64_t target = _lastId + 1 - _maxQueuedFrames;
+
+    // Timeouts and out of date swapchains aren't errors here : the frame simply goes on
+    _device.waitForPresent()(_device.logical(), _presented, target, Timeout);
+}
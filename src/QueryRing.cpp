@@ -0,0 +1,76 @@
+#include <QueryRing.hpp>
+#include <Device.hpp>
+#include <FrameContext.hpp>
+
+#include <algorithm>
+
+// One more than frames can be in flight : the pool being recorded to belongs to a frame that is done
+const uint32_t QueryRing::FrameLatency = FrameContext::MaxFramesInFlight + 1;
+
+QueryRing::QueryRing(const Device &device, const VkQueryPoolCreateInfo &queryPoolInfo, uint32_t valuesPerQuery) : _device(device),
+                                                                                                                   _current(nullptr),
+                                                                                                                   _poolSize(queryPoolInfo.queryCount),
+                                                                                                                   _valuesPerQuery(valuesPerQuery)
+{
+    _slots.resize(FrameLatency);
+    _values.resize(static_cast<size_t>(_poolSize) * _valuesPerQuery);
+
+    for (Slot &slot : _slots)
+        if (vkCreateQueryPool(_device.logical(), &queryPoolInfo, nullptr, &slot.pool) != VK_SUCCESS)
+            throw std::runtime_error("failed to create query pool!");
+}
+
+QueryRing::~QueryRing()
+{
+    for (Slot &slot : _slots)
+        vkDestroyQueryPool(_device.logical(), slot.pool, nullptr);
+}
+
+uint32_t QueryRing::beginFrame(VkCommandBuffer commandBuffer, uint64_t frameNumber)
+{
+    uint32_t slot = static_cast<uint32_t>(frameNumber % FrameLatency);
+    _current = &_slots[slot];
+    _current->frameNumber = frameNumber;
+    _current->queryCount = 0;
+    _current->pending = false;
+
+    // Can't happen inside a render pass, hence the frame starting outside of them
+    vkCmdResetQueryPool(commandBuffer, _current->pool, 0, _poolSize);
+    return slot;
+}
+
+void QueryRing::endFrame(uint32_t queryCount)
+{
+    if (!_current)
+        return;
+
+    _current->queryCount = std::min(queryCount, _poolSize);
+    _current->pending = true;
+    _current = nullptr;
+}
+
+void QueryRing::collect(const std::function<void(uint32_t slot, uint64_t frameNumber, const uint64_t *values, uint32_t queryCount)> &read)
+{
+    // Pools aren't laid out in frame order
+    std::vector<uint32_t> pending;
+    for (uint32_t slot = 0; slot < _slots.size(); slot++)
+        if (_slots[slot].pending)
+            pending.push_back(slot);
+    std::sort(pending.begin(), pending.end(), [this](uint32_t a, uint32_t b)
+              { return _slots[a].frameNumber < _slots[b].frameNumber; });
+
+    for (uint32_t index : pending)
+    {
+        Slot &slot = _slots[index];
+
+        // No WAIT flag : VK_NOT_READY until every query of the frame is in, it is then tried again on the next call
+        size_t stride = _valuesPerQuery * sizeof(uint64_t);
+        if (slot.queryCount != 0 &&
+            vkGetQueryPoolResults(_device.logical(), slot.pool, 0, slot.queryCount, slot.queryCount * stride, _values.data(), stride,
+                                  VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+            continue;
+
+        slot.pending = false;
+        read(index, slot.frameNumber, _values.data(), slot.queryCount);
+    }
+}
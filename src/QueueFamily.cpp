@@ -29,6 +29,20 @@ QueueFamily::QueueFamily(VkPhysicalDevice device, VkSurfaceKHR surface)
 
         i++;
     }
+
+    // Look for a dedicated transfer family : pure DMA engines first, then any non-graphics one
+    for (uint32_t j = 0; j < queueFamilyCount && !transferFamily.has_value(); j++)
+    {
+        auto flags = queueFamilies[j].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+            transferFamily = j;
+    }
+    for (uint32_t j = 0; j < queueFamilyCount && !transferFamily.has_value(); j++)
+    {
+        auto flags = queueFamilies[j].queueFlags;
+        if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT))
+            transferFamily = j;
+    }
 }
 
 bool QueueFamily::isComplete()
@@ -0,0 +1,130 @@
+#include <Readback.hpp>
+#include <Device.hpp>
+#include <SwapChain.hpp>
+#include <DeletionQueue.hpp>
+
+#include <fstream>
+#include <vector>
+
+/// @brief Whether red and blue have to be swapped to get RGB. Throws on formats the readback can't write
+static bool SwapsRedBlue(VkFormat format)
+{
+    switch (format)
+    {
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        return true;
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+        return false;
+    default:
+        throw std::runtime_error("unsupported swapchain format for readback!");
+    }
+}
+
+Readback::Readback(const Device &device, const SwapChain &swapChain) : _device(device),
+                                                                       _swapChain(swapChain),
+                                                                       _extent({0, 0}),
+                                                                       _format(VK_FORMAT_UNDEFINED)
+{
+}
+
+Readback::~Readback()
+{
+    if (_buffer.handle != VK_NULL_HANDLE)
+        _device.allocator().destroyBuffer(_buffer);
+}
+
+void Readback::record(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+    _extent = _swapChain.extent();
+    _format = _swapChain.imageFormat();
+    SwapsRedBlue(_format);
+
+    // 4 bytes per pixel, rows tightly packed
+    VkDeviceSize size = static_cast<VkDeviceSize>(_extent.width) * _extent.height * 4;
+    if (_buffer.size < size)
+    {
+        // The previous frame's copy may still be running
+        if (_buffer.handle != VK_NULL_HANDLE)
+            _device.deletionQueue().destroyBuffer(_buffer);
+        _buffer = _device.allocator().createBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, MemoryUsage::Readback);
+    }
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = _swapChain.image(imageIndex);
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    // The pass ended on a transition to PRESENT_SRC waited at BOTTOM_OF_PIPE, which only ALL_COMMANDS chains with
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = 0;
+    // 0 : tightly packed
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {_extent.width, _extent.height, 1};
+
+    vkCmdCopyImageToBuffer(commandBuffer, barrier.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, _buffer.handle, 1, &region);
+
+    // Back to presentation, which waits on the submission's semaphore anyway
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    // And the copy made visible to the host, once the submission is done
+    VkBufferMemoryBarrier hostBarrier{};
+    hostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    hostBarrier.buffer = _buffer.handle;
+    hostBarrier.offset = 0;
+    hostBarrier.size = size;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                         0, nullptr, 1, &hostBarrier, 0, nullptr);
+}
+
+void Readback::save(const std::string &path) const
+{
+    if (_buffer.handle == VK_NULL_HANDLE)
+        throw std::runtime_error("nothing was read back!");
+
+    VkDeviceSize size = static_cast<VkDeviceSize>(_extent.width) * _extent.height * 4;
+    _device.allocator().invalidate(_buffer.allocation, 0, size);
+
+    bool swapRedBlue = SwapsRedBlue(_format);
+    const uint8_t *pixels = static_cast<const uint8_t *>(_buffer.allocation.mapped);
+
+    // Alpha dropped, PPM has none
+    std::vector<uint8_t> rgb(static_cast<size_t>(_extent.width) * _extent.height * 3);
+    for (size_t i = 0; i < static_cast<size_t>(_extent.width) * _extent.height; i++)
+    {
+        rgb[i * 3 + 0] = pixels[i * 4 + (swapRedBlue ? 2 : 0)];
+        rgb[i * 3 + 1] = pixels[i * 4 + 1];
+        rgb[i * 3 + 2] = pixels[i * 4 + (swapRedBlue ? 0 : 2)];
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("failed to open readback file!");
+
+    file << "P6\n"
+         << _extent.width << ' ' << _extent.height << "\n255\n";
+    file.write(reinterpret_cast<const char *>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+}
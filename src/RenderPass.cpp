@@ -1,6 +1,7 @@
 #include <RenderPass.hpp>
 #include <Device.hpp>
 #include <SwapChain.hpp>
+#include <DeletionQueue.hpp>
 
 void RenderPass::createFrameBuffers()
 {
@@ -31,33 +32,192 @@ void RenderPass::destroyFrameBuffers()
         vkDestroyFramebuffer(_device.logical(), buffer, nullptr);
 }
 
-RenderPass::RenderPass(const Device &device, const SwapChain &swapChain) : _oldRenderPass(VK_NULL_HANDLE),
-                                                                           _device(device),
-                                                                           _swapChain(swapChain)
+RenderPass::RenderPass(const Device &device, const SwapChain &swapChain, bool dynamic) : _renderPass(VK_NULL_HANDLE),
+                                                                                         _device(device),
+                                                                                         _swapChain(swapChain),
+                                                                                         _dynamic(dynamic),
+                                                                                         _format(VK_FORMAT_UNDEFINED),
+                                                                                         _generation(0),
+                                                                                         _contents(VK_SUBPASS_CONTENTS_INLINE)
 {
 }
 
 RenderPass::~RenderPass()
 {
     destroyFrameBuffers();
-    cleanupOld();
     vkDestroyRenderPass(_device.logical(), _renderPass, nullptr);
 }
 
-void RenderPass::cleanupOld()
+void RenderPass::begin(VkCommandBuffer commandBuffer, uint32_t imageIndex, VkSubpassContents contents) const
 {
-    if (_oldRenderPass != VK_NULL_HANDLE)
+    if (_dynamic)
     {
-        vkDestroyRenderPass(_device.logical(), _oldRenderPass, nullptr);
-        _oldRenderPass = VK_NULL_HANDLE;
+        // What the render pass did through its initial layout and external dependency.
+        // The source stage matches the acquire semaphore wait stage, so the transition happens after the acquire
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = _swapChain.image(imageIndex);
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0,
+                             0, nullptr, 0, nullptr, 1, &barrier);
+
+        beginRendering(commandBuffer, imageIndex, VK_ATTACHMENT_LOAD_OP_CLEAR, contents);
+        return;
+    }
+
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = _renderPass;
+    renderPassInfo.framebuffer = _frameBuffers[imageIndex];
+    renderPassInfo.renderArea.offset = {0, 0};
+    renderPassInfo.renderArea.extent = _swapChain.extent();
+
+    // Choose the color to clear the image : solid black for now
+    VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
+    renderPassInfo.clearValueCount = 1;
+    renderPassInfo.pClearValues = &clearColor;
+
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+}
+
+void RenderPass::nextSubpass(VkCommandBuffer commandBuffer, uint32_t imageIndex, VkSubpassContents contents) const
+{
+    if (!_dynamic)
+    {
+        vkCmdNextSubpass(commandBuffer, contents);
+        return;
+    }
+
+    // Same contents : the next draws simply go on in the current rendering, the image never leaves the tile
+    if (contents == _contents)
+        return;
+
+    _device.cmdEndRendering()(commandBuffer);
+
+    // The next rendering blends over what was just written
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_DEPENDENCY_BY_REGION_BIT,
+                         1, &barrier, 0, nullptr, 0, nullptr);
+
+    beginRendering(commandBuffer, imageIndex, VK_ATTACHMENT_LOAD_OP_LOAD, contents);
+}
+
+void RenderPass::end(VkCommandBuffer commandBuffer, uint32_t imageIndex) const
+{
+    if (!_dynamic)
+    {
+        vkCmdEndRenderPass(commandBuffer);
+        return;
     }
+
+    _device.cmdEndRendering()(commandBuffer);
+
+    // Final layout of the render pass : ready for presentation, which is ordered by the semaphore, not by a stage
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = _swapChain.image(imageIndex);
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                         0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void RenderPass::beginRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, VkAttachmentLoadOp loadOp, VkSubpassContents contents) const
+{
+    VkRenderingAttachmentInfoKHR colorAttachment{};
+    colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+    colorAttachment.imageView = _swapChain.imageView(imageIndex);
+    colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    colorAttachment.loadOp = loadOp;
+    colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    // Solid black, as with the render pass
+    colorAttachment.clearValue = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
+
+    VkRenderingInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    renderingInfo.flags = contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR : 0;
+    renderingInfo.renderArea.offset = {0, 0};
+    renderingInfo.renderArea.extent = _swapChain.extent();
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachments = &colorAttachment;
+
+    _device.cmdBeginRendering()(commandBuffer, &renderingInfo);
+    _contents = contents;
+}
+
+void RenderPass::beginSecondary(VkCommandBuffer commandBuffer, uint32_t subpass, uint32_t imageIndex, VkCommandBufferUsageFlags flags) const
+{
+    VkFormat format = colorFormat();
+    VkCommandBufferInheritanceRenderingInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR;
+    renderingInfo.colorAttachmentCount = 1;
+    renderingInfo.pColorAttachmentFormats = &format;
+    renderingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    if (_dynamic)
+        inheritanceInfo.pNext = &renderingInfo;
+    else
+    {
+        inheritanceInfo.renderPass = _renderPass;
+        inheritanceInfo.subpass = subpass;
+        // Optional, but lets the driver specialise the commands for the framebuffer
+        inheritanceInfo.framebuffer = _frameBuffers[imageIndex];
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | flags;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin recording secondary command buffer!");
+}
+
+VkFramebuffer RenderPass::target(uint32_t imageIndex) const
+{
+    return _dynamic ? VK_NULL_HANDLE : _frameBuffers[imageIndex];
+}
+
+VkFormat RenderPass::colorFormat() const
+{
+    return _swapChain.imageFormat();
 }
 
 void RenderPass::recreate()
 {
-    destroyFrameBuffers();
-    cleanupOld();
-    _oldRenderPass = _renderPass;
-    createRenderPass();
+    // Every pipeline drawing in the pass, ImGui's included, was built for the format : none of them follows a new one
+    if (_swapChain.imageFormat() != _format)
+        throw std::runtime_error("swapchain image format changed, the render pass and its pipelines can't follow!");
+
+    _generation++;
+
+    // Image views are picked from the swapchain at record time : nothing to rebuild
+    if (_dynamic)
+        return;
+
+    // Still referenced by the command buffers of the frames in flight
+    for (auto &buffer : _frameBuffers)
+        _device.deletionQueue().destroyFramebuffer(buffer);
+
+    // The render pass doesn't care about the extent : a resize keeps it, along with every pipeline made against it
     createFrameBuffers();
 }
\ No newline at end of file
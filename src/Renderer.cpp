@@ -4,44 +4,76 @@
 #include <RenderPass.hpp>
 #include <GraphicsPipeline.hpp>
 #include <QueueFamily.hpp>
+#include <FrameContext.hpp>
+#include <PipelineStatistics.hpp>
+#include <JobSystem.hpp>
+
+#include <atomic>
+
+static std::atomic<uint64_t> NextRendererId{0};
 
 Renderer::Renderer(const Device &device,
-                         const RenderPass &renderPass,
-                         const SwapChain &swapChain,
-                         const GraphicsPipeline &graphicsPipeline,
-                         const VkCommandPoolCreateFlags &flags) : _flags(flags),
-                                                                  _device(device),
-                                                                  _renderPass(renderPass),
-                                                                  _swapChain(swapChain),
-                                                                  _graphicsPipeline(graphicsPipeline)
+                   const RenderPass &renderPass,
+                   const SwapChain &swapChain,
+                   const GraphicsPipeline &graphicsPipeline) : _device(device),
+                                                               _renderPass(renderPass),
+                                                               _swapChain(swapChain),
+                                                               _graphicsPipeline(graphicsPipeline),
+                                                               _cache(device),
+                                                               _version(0),
+                                                               _id(NextRendererId.fetch_add(1, std::memory_order_relaxed))
 {
-    VkCommandPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    poolInfo.queueFamilyIndex = _device.queueFamilyIndices().graphicsFamily.value();
-
-    if (vkCreateCommandPool(_device.logical(), &poolInfo, nullptr, &_pool) != VK_SUCCESS)
-        throw std::runtime_error("failed to create command pool!");
 }
 
-Renderer::~Renderer()
+void Renderer::captureState(DrawState &state) const
 {
-    destroyCommandBuffers();
-    vkDestroyCommandPool(_device.logical(), _pool, nullptr);
+    state.version = _version;
+    state.instanceCount = 1;
+    state.streamedVertices.clear();
 }
 
-void Renderer::recreateCommandBuffers()
+CommandKey Renderer::cacheKey(uint32_t imageIndex, const DrawState &state) const
 {
-    destroyCommandBuffers();
-    createCommandBuffers();
+    CommandKey key;
+    key.pipeline = _graphicsPipeline.pipeline();
+    key.framebuffer = _renderPass.target(imageIndex);
+    key.extent = _swapChain.extent();
+    key.generation = _renderPass.generation();
+    key.version = state.version;
+    return key;
 }
 
-void Renderer::destroyCommandBuffers()
+VkCommandBuffer Renderer::secondary(FrameContext &frame, uint32_t subpass, uint32_t imageIndex, const DrawState &state, PipelineStatistics *statistics,
+                                    const char *pass)
 {
-    vkFreeCommandBuffers(_device.logical(), _pool, _commandBuffers.size(), _commandBuffers.data());
-}
+    // A cached buffer would point to the queries of the frame it was recorded for
+    bool counted = statistics && statistics->recording();
+    if (!cacheable(state) || counted)
+    {
+        VkCommandBuffer commandBuffer = frame.secondaryPool(JobSystem::ThreadIndex()).acquire();
+        _renderPass.beginSecondary(commandBuffer, subpass, imageIndex, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        uint32_t query = counted ? statistics->begin(commandBuffer, pass) : PipelineStatistics::NoQuery;
+        record(commandBuffer, frame, state);
+        if (counted)
+            statistics->end(commandBuffer, query);
+        if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("failed to record secondary command buffer!");
+        return commandBuffer;
+    }
 
-void Renderer::recordCommandBuffer(uint32_t index) {}
+    CommandKey key = cacheKey(imageIndex, state);
+
+    // With dynamic rendering, one buffer serves every image
+    uint32_t slot = key.framebuffer != VK_NULL_HANDLE ? imageIndex : 0;
+
+    return _cache.get(slot, key, [&](VkCommandBuffer commandBuffer)
+                      {
+                          // Replayed by several frames in flight at once
+                          _renderPass.beginSecondary(commandBuffer, subpass, imageIndex, VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
+                          record(commandBuffer, frame, state);
+                          if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+                              throw std::runtime_error("failed to record cached command buffer!"); });
+}
 
 void Renderer::SingleTimeCommands(const Device &device, VkCommandPool &pool, const std::function<void(const VkCommandBuffer &)> &func)
 {
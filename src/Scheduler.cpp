@@ -0,0 +1,107 @@
+#include <Scheduler.hpp>
+#include <Device.hpp>
+
+#include <algorithm>
+
+Scheduler::Scheduler(const Device &device) : _device(device),
+                                             _timelines{Timeline(device), Timeline(device)}
+{
+}
+
+VkQueue Scheduler::queue(QueueType type) const
+{
+    return type == QueueType::Transfer ? _device.transferQueue() : _device.graphicsQueue();
+}
+
+uint64_t Scheduler::submit(QueueType type, std::span<const VkCommandBuffer> commandBuffers, std::span<const SemaphoreWait> waits, std::span<const VkSemaphore> binarySignals)
+{
+    Timeline &signaled = timeline(type);
+    uint64_t value = signaled.next();
+
+    _waitSemaphores.clear();
+    _waitValues.clear();
+    _waitStages.clear();
+    for (const SemaphoreWait &wait : waits)
+    {
+        _waitSemaphores.push_back(wait.semaphore);
+        _waitValues.push_back(wait.value);
+        _waitStages.push_back(wait.stages);
+    }
+
+    // Timeline first, then the binary semaphores, whose values are ignored
+    _signalSemaphores.assign(1, signaled.handle());
+    _signalValues.assign(1, value);
+    for (VkSemaphore semaphore : binarySignals)
+    {
+        _signalSemaphores.push_back(semaphore);
+        _signalValues.push_back(0);
+    }
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(_waitValues.size());
+    timelineInfo.pWaitSemaphoreValues = _waitValues.data();
+    timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(_signalValues.size());
+    timelineInfo.pSignalSemaphoreValues = _signalValues.data();
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = static_cast<uint32_t>(_waitSemaphores.size());
+    submitInfo.pWaitSemaphores = _waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = _waitStages.data();
+    submitInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+    submitInfo.pCommandBuffers = commandBuffers.data();
+    submitInfo.signalSemaphoreCount = static_cast<uint32_t>(_signalSemaphores.size());
+    submitInfo.pSignalSemaphores = _signalSemaphores.data();
+
+    if (vkQueueSubmit(queue(type), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        throw std::runtime_error("failed to submit command buffers!");
+
+    return value;
+}
+
+SemaphoreWait Scheduler::after(QueueType type, uint64_t value, VkPipelineStageFlags stages) const
+{
+    return {timeline(type).handle(), value, stages};
+}
+
+void Scheduler::wait(std::initializer_list<std::pair<QueueType, uint64_t>> values) const
+{
+    // Highest value asked per queue, so the wait stays a single driver call whatever is passed
+    std::array<uint64_t, 2> targets{};
+    for (auto [type, value] : values)
+        targets[static_cast<size_t>(type)] = std::max(targets[static_cast<size_t>(type)], value);
+
+    std::array<VkSemaphore, 2> semaphores;
+    std::array<uint64_t, 2> waitValues;
+    uint32_t count = 0;
+
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        QueueType type = static_cast<QueueType>(i);
+        if (reached(type, targets[i]))
+            continue;
+        semaphores[count] = timeline(type).handle();
+        waitValues[count] = targets[i];
+        count++;
+    }
+
+    if (count == 0)
+        return;
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = count;
+    waitInfo.pSemaphores = semaphores.data();
+    waitInfo.pValues = waitValues.data();
+
+    if (vkWaitSemaphores(_device.logical(), &waitInfo, UINT64_MAX) != VK_SUCCESS)
+        throw std::runtime_error("failed to wait on timeline semaphores!");
+}
+
+void Scheduler::waitIdle() const
+{
+    wait({{QueueType::Graphics, timeline(QueueType::Graphics).pending()},
+          {QueueType::Transfer, timeline(QueueType::Transfer).pending()}});
+}
@@ -2,17 +2,18 @@
 #include <Window.hpp>
 #include <Device.hpp>
 #include <QueueFamily.hpp>
+#include <DeletionQueue.hpp>
 
 #include <cmath>
 #include <algorithm>
 
-void SwapChain::createSwapChain()
+void SwapChain::createSwapChain(VkSwapchainKHR oldSwapChain)
 {
     // Fetch support details
     _supportDetails = QuerySwapChainSupport(_device.physical(), _window.surface());
     VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(_supportDetails.formats);
-    VkPresentModeKHR presentMode = ChooseSwapPresentMode(_supportDetails.presentModes);
-    _extent = ChooseSwapExtent(_supportDetails.capabilities, _window);
+    _presentMode = ChooseSwapPresentMode(_supportDetails.presentModes, _requestedPresentMode);
+    _extent = ChooseSwapExtent(_supportDetails.capabilities, _framebufferSize);
     _imageFormat = surfaceFormat.format;
 
     // 1 more image than the minimum is usually enough to not have too much wait time, while keeping a light enough load
@@ -35,7 +36,9 @@ void SwapChain::createSwapChain()
     createInfo.imageColorSpace = surfaceFormat.colorSpace;
     createInfo.imageExtent = _extent;
     createInfo.imageArrayLayers = 1;
-    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | _extraUsage;
+    if ((_supportDetails.capabilities.supportedUsageFlags & createInfo.imageUsage) != createInfo.imageUsage)
+        throw std::runtime_error("swapchain images don't support the requested usage!");
 
     QueueFamily indices(_device.physical(), _window.surface());
     uint32_t queueFamilyIndices[] = {indices.graphicsFamily.value(), indices.presentFamily.value()};
@@ -62,11 +65,11 @@ void SwapChain::createSwapChain()
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 
     // Sets present mode and enables clipping (not rendering pixels not shown on screen)
-    createInfo.presentMode = presentMode;
+    createInfo.presentMode = _presentMode;
     createInfo.clipped = VK_TRUE;
 
     // Set the old swap chain
-    createInfo.oldSwapchain = _oldSwapChain;
+    createInfo.oldSwapchain = oldSwapChain;
 
     if (vkCreateSwapchainKHR(_device.logical(), &createInfo, nullptr, &_swapChain) != VK_SUCCESS)
         throw std::runtime_error("Failed to create swap chain!");
@@ -139,12 +142,11 @@ VkSurfaceFormatKHR SwapChain::ChooseSwapSurfaceFormat(const std::vector<VkSurfac
     return availableFormats[0];
 }
 
-VkPresentModeKHR SwapChain::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes)
+VkPresentModeKHR SwapChain::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes, VkPresentModeKHR requested)
 {
-    // Choose Mailbox if available (triple buffering is kinda nice)
     for (const auto &availablePresentMode : availablePresentModes)
     {
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+        if (availablePresentMode == requested)
         {
             return availablePresentMode;
         }
@@ -154,14 +156,36 @@ VkPresentModeKHR SwapChain::ChooseSwapPresentMode(const std::vector<VkPresentMod
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
-SwapChain::SwapChain(const Device &device, const Window &window) : _device(device), _window(window), _oldSwapChain(VK_NULL_HANDLE)
+const char *SwapChain::PresentModeName(VkPresentModeKHR presentMode)
 {
-    createSwapChain();
+    switch (presentMode)
+    {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+        return "Immediate";
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+        return "Mailbox";
+    case VK_PRESENT_MODE_FIFO_KHR:
+        return "FIFO";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+        return "FIFO relaxed";
+    default:
+        return "Unknown";
+    }
+}
+
+// Mailbox if available (triple buffering is kinda nice)
+SwapChain::SwapChain(const Device &device, const Window &window, VkImageUsageFlags extraUsage) : _device(device), _window(window), _swapChain(VK_NULL_HANDLE), _requestedPresentMode(VK_PRESENT_MODE_MAILBOX_KHR), _presentMode(VK_PRESENT_MODE_FIFO_KHR), _extraUsage(extraUsage)
+{
+    // Built on the main thread, the window can still be asked
+    _window.framebufferSize(_framebufferSize);
+    createSwapChain(VK_NULL_HANDLE);
     createImageViews();
 }
 
 SwapChain::~SwapChain()
 {
+    destroyImageViews();
+
     if (_swapChain != VK_NULL_HANDLE)
         // Destroy the swapchain
         vkDestroySwapchainKHR(_device.logical(), _swapChain, nullptr);
@@ -194,7 +218,7 @@ SwapChainSupportDetails SwapChain::QuerySwapChainSupport(const VkPhysicalDevice
     return details;
 }
 
-VkExtent2D SwapChain::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities, const Window &window)
+VkExtent2D SwapChain::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities, const glm::ivec2 &framebufferSize)
 {
     // If window resolution is used normally
     if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max())
@@ -203,10 +227,10 @@ VkExtent2D SwapChain::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilit
     }
     else
     {
-        // Fetch current height & width
+        // Framebuffer size, in pixels : the window size is in screen coordinates, and never follows resizes
         VkExtent2D actualExtent = {
-            static_cast<uint32_t>(window.size().x),
-            static_cast<uint32_t>(window.size().y)};
+            static_cast<uint32_t>(framebufferSize.x),
+            static_cast<uint32_t>(framebufferSize.y)};
 
         // Get closest available value
         actualExtent.width = std::clamp(actualExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
@@ -218,18 +242,13 @@ VkExtent2D SwapChain::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilit
 
 void SwapChain::recreate()
 {
-    destroyImageViews();
-    cleanupOld();
-    _oldSwapChain = _swapChain;
-    createSwapChain();
-    createImageViews();
-}
+    // Frames in flight may still render to the old views and present the old images
+    for (auto imageView : _imageViews)
+        _device.deletionQueue().destroyImageView(imageView);
 
-void SwapChain::cleanupOld()
-{ // Destroy old swap chain if it exists
-    if (_oldSwapChain != VK_NULL_HANDLE)
-    {
-        vkDestroySwapchainKHR(_device.logical(), _oldSwapChain, nullptr);
-        _oldSwapChain = VK_NULL_HANDLE;
-    }
+    VkSwapchainKHR oldSwapChain = _swapChain;
+    createSwapChain(oldSwapChain);
+    _device.deletionQueue().destroySwapChain(oldSwapChain);
+
+    createImageViews();
 }
@@ -0,0 +1,56 @@
+#include <Timeline.hpp>
+#include <Device.hpp>
+
+#include <algorithm>
+
+Timeline::Timeline(const Device &device) : _device(device),
+                                           _pending(0),
+                                           _completed(0)
+{
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    if (vkCreateSemaphore(_device.logical(), &semaphoreInfo, nullptr, &_semaphore) != VK_SUCCESS)
+        throw std::runtime_error("failed to create timeline semaphore!");
+}
+
+Timeline::~Timeline()
+{
+    vkDestroySemaphore(_device.logical(), _semaphore, nullptr);
+}
+
+uint64_t Timeline::next()
+{
+    return ++_pending;
+}
+
+uint64_t Timeline::completed() const
+{
+    if (vkGetSemaphoreCounterValue(_device.logical(), _semaphore, &_completed) != VK_SUCCESS)
+        throw std::runtime_error("failed to read timeline semaphore value!");
+
+    return _completed;
+}
+
+void Timeline::wait(uint64_t value) const
+{
+    if (reached(value))
+        return;
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &_semaphore;
+    waitInfo.pValues = &value;
+
+    if (vkWaitSemaphores(_device.logical(), &waitInfo, UINT64_MAX) != VK_SUCCESS)
+        throw std::runtime_error("failed to wait on timeline semaphore!");
+
+    _completed = std::max(_completed, value);
+}
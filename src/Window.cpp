@@ -1,16 +1,24 @@
 #include <Window.hpp>
 #include <Messenger.hpp>
+#include <CpuProfiler.hpp>
 #include "Application.hpp"
 
 const std::vector<const char *> Window::ValidationLayers = {
     "VK_LAYER_KHRONOS_validation"};
 const std::vector<const char *> Window::DeviceExtensions = {
     VK_KHR_SWAPCHAIN_EXTENSION_NAME};
-
-Window::Window(const std::string appName, const glm::ivec2 size, const char *engineName, const bool enableLayers) : _title(appName),
-                                                                                                                    _size(size),
-                                                                                                                    _surface(VK_NULL_HANDLE),
-                                                                                                                    _enableValidationLayers(enableLayers)
+// 1.2 for timeline semaphores
+const uint32_t Window::ApiVersion = VK_API_VERSION_1_2;
+
+Window::Window(const std::string appName, const glm::ivec2 size, const char *engineName, const bool enableLayers, const bool headless) : _title(appName),
+                                                                                                                                         _size(size),
+                                                                                                                                         _window(nullptr),
+                                                                                                                                         _surface(VK_NULL_HANDLE),
+                                                                                                                                         _headless(headless),
+                                                                                                                                         _closeRequested(false),
+                                                                                                                                         _resized(false),
+                                                                                                                                         _drawing(false),
+                                                                                                                                         _enableValidationLayers(enableLayers)
 {
 
     // ------------------------- CREATE VULKAN INSTANCE ----------------------
@@ -19,6 +27,9 @@ Window::Window(const std::string appName, const glm::ivec2 size, const char *eng
         throw std::runtime_error("Validation layers requested, but not available!");
     }
 
+    if (_headless && !CheckHeadlessSurfaceSupport())
+        throw std::runtime_error("Headless mode requested, but VK_EXT_headless_surface is not available!");
+
     // Determine application info
     VkApplicationInfo appInfo{};
     appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -26,7 +37,7 @@ Window::Window(const std::string appName, const glm::ivec2 size, const char *eng
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = engineName;
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    appInfo.apiVersion = ApiVersion;
 
     // Additional info for instance
     VkInstanceCreateInfo createInfo{};
@@ -62,11 +73,27 @@ Window::Window(const std::string appName, const glm::ivec2 size, const char *eng
 
     std::cout << "Successfully created Vulkan instance" << '\n';
 
+    // ------------------------------- CREATE HEADLESS SURFACE
+    if (_headless)
+    {
+        // Extension function : not exported by every loader
+        auto createHeadlessSurface = (PFN_vkCreateHeadlessSurfaceEXT)vkGetInstanceProcAddr(_instance, "vkCreateHeadlessSurfaceEXT");
+
+        VkHeadlessSurfaceCreateInfoEXT surfaceInfo{};
+        surfaceInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+
+        if (!createHeadlessSurface || createHeadlessSurface(_instance, &surfaceInfo, nullptr, &_surface) != VK_SUCCESS)
+            throw std::runtime_error("Failed to create headless surface!");
+
+        return;
+    }
+
     // ------------------------------- CREATE GLFW WINDOWS
     _window = glfwCreateWindow(size.x, size.y, "Vulkan", nullptr, nullptr);
 
     glfwSetWindowUserPointer(_window, this);
     glfwSetFramebufferSizeCallback(_window, FramebufferResizeCallback);
+    glfwSetWindowRefreshCallback(_window, WindowRefreshCallback);
 
     if (glfwCreateWindowSurface(_instance, _window, nullptr, &_surface) != VK_SUCCESS)
     {
@@ -78,23 +105,39 @@ Window::~Window()
 {
     vkDestroySurfaceKHR(_instance, _surface, nullptr);
     vkDestroyInstance(_instance, nullptr);
-    glfwDestroyWindow(_window);
+    if (_window)
+        glfwDestroyWindow(_window);
 }
 
-void Window::mainLoop(const Device &device)
+void Window::mainLoop()
 {
-    while (!glfwWindowShouldClose(_window))
+    while (!shouldClose())
     {
-        glfwPollEvents();
+        CPU_FRAME_MARK();
+
+        if (!_headless)
+        {
+            CPU_ZONE("PollEvents");
+            glfwPollEvents();
+        }
+
+        _drawing = true;
         _drawFrameFunc(_resized);
+        _drawing = false;
     }
-
-    vkDeviceWaitIdle(device.logical());
-    vkQueueWaitIdle(device.presentQueue());
 }
 
 std::vector<const char *> Window::getRequiredExtensions()
 {
+    // GLFW isn't even initialized : the surface is ours
+    if (_headless)
+    {
+        std::vector<const char *> extensions = {VK_KHR_SURFACE_EXTENSION_NAME, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME};
+        if (_enableValidationLayers)
+            extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        return extensions;
+    }
+
     uint32_t glfwExtensionCount = 0;
     const char **glfwExtensions;
     glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
@@ -115,6 +158,20 @@ void Window::FramebufferResizeCallback(GLFWwindow *window, int width, int height
     win->_resized = true;
 }
 
+void Window::WindowRefreshCallback(GLFWwindow *window)
+{
+    Window *win = reinterpret_cast<Window *>(glfwGetWindowUserPointer(window));
+
+    // Also called from the events polled by the draw callback itself, or before the application set it
+    if (win->_drawing || !win->_drawFrameFunc)
+        return;
+
+    CPU_ZONE("WindowRefresh");
+    win->_drawing = true;
+    win->_drawFrameFunc(win->_resized);
+    win->_drawing = false;
+}
+
 bool Window::CheckValidationLayerSupport()
 {
     uint32_t layerCount;
@@ -150,4 +207,19 @@ bool Window::CheckValidationLayerSupport()
               << '\n';
 
     return true;
+}
+
+bool Window::CheckHeadlessSurfaceSupport()
+{
+    uint32_t extensionCount;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto &extension : availableExtensions)
+        if (strcmp(extension.extensionName, VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME) == 0)
+            return true;
+
+    return false;
 }
\ No newline at end of file
@@ -4,48 +4,47 @@
 #include <Device.hpp>
 #include <SwapChain.hpp>
 #include <GraphicsPipeline.hpp>
+#include <memory/Uploader.hpp>
+#include <FrameContext.hpp>
 
 #include <cstring>
 
-BaseRenderer::BaseRenderer(const Device &device, const RenderPass &renderPass, const SwapChain &swapChain, const GraphicsPipeline &graphicsPipeline, const VkCommandPoolCreateFlags &flags, std::vector<Vertex> vertices) : Renderer(device, renderPass, swapChain, graphicsPipeline, flags), vertices(vertices)
+BaseRenderer::BaseRenderer(const Device &device, const RenderPass &renderPass, const SwapChain &swapChain, const GraphicsPipeline &graphicsPipeline, Mesh mesh) : Renderer(device, renderPass, swapChain, graphicsPipeline),
+                                                                                                                                                                  _indexCount(static_cast<uint32_t>(mesh.indices.size())),
+                                                                                                                                                                  _indexType(mesh.indexType()),
+                                                                                                                                                                  mesh(std::move(mesh))
 {
-    createCommandBuffers();
     createVertexBuffer();
+    createIndexBuffer();
 }
 
-BaseRenderer::~BaseRenderer()
+BaseRenderer::BaseRenderer(const Device &device, const RenderPass &renderPass, const SwapChain &swapChain, const GraphicsPipeline &graphicsPipeline, const MeshFile &meshFile) : Renderer(device, renderPass, swapChain, graphicsPipeline),
+                                                                                                                                                                                 _indexCount(meshFile.lod(0).indexCount),
+                                                                                                                                                                                 _indexType(meshFile.indexType())
 {
-    vkDestroyBuffer(_device.logical(), _vertexBuffer, nullptr);
-    vkFreeMemory(_device.logical(), _vertexBufferMemory, nullptr);
+    uploadMeshFile(meshFile);
 }
-void BaseRenderer::recordCommandBuffer(uint32_t index)
-{
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = 0;                  // Optional
-    beginInfo.pInheritanceInfo = nullptr; // Optional
-
-    if (vkBeginCommandBuffer(_commandBuffers[index], &beginInfo) != VK_SUCCESS)
-        throw std::runtime_error("failed to begin recording command buffer!");
 
-    // Begin the render pass
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = _renderPass.handle();
-    renderPassInfo.framebuffer = _renderPass.frameBuffer(index);
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = _swapChain.extent();
-
-    // Choose the color to clear the image : solid black for now
-    VkClearValue clearColor = {{{0.0f, 0.0f, 0.0f, 1.0f}}};
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColor;
+BaseRenderer::~BaseRenderer()
+{
+    for (Buffer &buffer : _vertexBuffers)
+        _device.allocator().destroyBuffer(buffer);
+    _device.allocator().destroyBuffer(_indexBuffer);
+}
 
-    // ------------- BEGINNING RENDER PASS ------------------
-    // No secondary buffer commands, so INLINE it is
-    vkCmdBeginRenderPass(_commandBuffers[index], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+void BaseRenderer::captureState(DrawState &state) const
+{
+    state.version = _version;
+    state.instanceCount = instanceCount;
+    if (dynamicVertices)
+        state.streamedVertices.assign(mesh.vertices.begin(), mesh.vertices.end());
+    else
+        state.streamedVertices.clear();
+}
 
-    vkCmdBindPipeline(_commandBuffers[index], VK_PIPELINE_BIND_POINT_GRAPHICS, _graphicsPipeline.pipeline());
+void BaseRenderer::record(VkCommandBuffer commandBuffer, FrameContext &frame, const DrawState &state)
+{
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _graphicsPipeline.pipeline());
 
     // We specified use of dynamic viewport & scissor states, so we have to configure them before drawing
     VkViewport viewport{};
@@ -55,89 +54,64 @@ void BaseRenderer::recordCommandBuffer(uint32_t index)
     viewport.height = static_cast<float>(_swapChain.extent().height);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
-    vkCmdSetViewport(_commandBuffers[index], 0, 1, &viewport);
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
     VkRect2D scissor{};
     scissor.offset = {0, 0};
     scissor.extent = _swapChain.extent();
-    vkCmdSetScissor(_commandBuffers[index], 0, 1, &scissor);
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    // Bind vertex buffers
-    VkBuffer vertexBuffers[] = {_vertexBuffer};
-    VkDeviceSize offsets[] = {0};
-    vkCmdBindVertexBuffers(_commandBuffers[index], 0, 1, vertexBuffers, offsets);
+    // Bind vertex buffers, one per stream : either the static ones, or this frame's copy of the vertices
+    std::array<VkBuffer, Vertex::Layout::BindingCount> vertexBuffers;
+    std::array<VkDeviceSize, Vertex::Layout::BindingCount> offsets{};
+    for (uint32_t stream = 0; stream < Vertex::Layout::BindingCount; stream++)
+    {
+        vertexBuffers[stream] = _vertexBuffers[stream].handle;
+        if (!state.streamedVertices.empty())
+        {
+            // Packed right into the mapped ring, no staging copy
+            RingSlice slice = frame.ring().allocate(state.streamedVertices.size() * Vertex::StreamStride(stream), sizeof(float));
+            Vertex::PackStream(state.streamedVertices, stream, slice.data);
+            vertexBuffers[stream] = slice.buffer;
+            offsets[stream] = slice.offset;
+        }
+    }
+    vkCmdBindVertexBuffers(commandBuffer, 0, Vertex::Layout::BindingCount, vertexBuffers.data(), offsets.data());
+    vkCmdBindIndexBuffer(commandBuffer, _indexBuffer.handle, 0, _indexType);
 
     // LETSGOOOO WE'RE DRAWING NOW !!!!!!
     // A bit underwhelming, yeah, but it'll change later
-    vkCmdDraw(_commandBuffers[index], static_cast<uint32_t>(vertices.size()), 1, 0, 0);
-
-    // End render pass
-    vkCmdEndRenderPass(_commandBuffers[index]);
-
-    // Close command buffer
-    if (vkEndCommandBuffer(_commandBuffers[index]) != VK_SUCCESS)
-        throw std::runtime_error("failed to record command buffer!");
+    vkCmdDrawIndexed(commandBuffer, _indexCount, state.instanceCount, 0, 0, 0);
 }
 
-void BaseRenderer::createCommandBuffers()
+void BaseRenderer::createVertexBuffer()
 {
-    // Allow only as many commandbffers as there are frames in the render pass
-    _commandBuffers.resize(_renderPass.size());
-
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = _pool;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandBufferCount = _commandBuffers.size();
-
-    if (vkAllocateCommandBuffers(_device.logical(), &allocInfo, _commandBuffers.data()) != VK_SUCCESS)
-        throw std::runtime_error("Failed to allocate command buffers!");
+    // Vertices live in DEVICE_LOCAL memory, filled by the uploader, one buffer per stream
+    for (uint32_t stream = 0; stream < Vertex::Layout::BindingCount; stream++)
+    {
+        std::vector<uint8_t> packed = Vertex::PackStream(mesh.vertices, stream);
+        _vertexBuffers[stream] = _device.uploader().createBuffer(packed.data(), packed.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+    }
 }
 
-void BaseRenderer::createVertexBuffer()
+void BaseRenderer::createIndexBuffer()
 {
-    VkBufferCreateInfo bufferInfo{};
-    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-    bufferInfo.size = sizeof(vertices[0]) * vertices.size();
-    bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-    if (vkCreateBuffer(_device.logical(), &bufferInfo, nullptr, &_vertexBuffer) != VK_SUCCESS)
-        throw std::runtime_error("failed to create vertex buffer!");
-
-    // Check the memory requirements of the GPU
-    VkMemoryRequirements memRequirements;
-    vkGetBufferMemoryRequirements(_device.logical(), _vertexBuffer, &memRequirements);
-
-    // Allocate the necessary memory for the vertex buffer
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-    if (vkAllocateMemory(_device.logical(), &allocInfo, nullptr, &_vertexBufferMemory) != VK_SUCCESS)
-        throw std::runtime_error("failed to allocate vertex buffer memory!");
-
-    // Bind the memory to the buffer
-    vkBindBufferMemory(_device.logical(), _vertexBuffer, _vertexBufferMemory, 0);
-
-    // Copy the actual data into the buffer
-    void *data;
-    vkMapMemory(_device.logical(), _vertexBufferMemory, 0, bufferInfo.size, 0, &data);
-    memcpy(data, vertices.data(), (size_t)bufferInfo.size);
-    vkUnmapMemory(_device.logical(), _vertexBufferMemory);
+    // 16-bit indices when the mesh allows it, halving the index fetch bandwidth
+    std::vector<uint8_t> indices = mesh.packedIndices();
+
+    _indexBuffer = _device.uploader().createBuffer(indices.data(), indices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                                                   VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT);
 }
 
-uint32_t BaseRenderer::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+void BaseRenderer::uploadMeshFile(const MeshFile &meshFile)
 {
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(_device.physical(), &memProperties);
+    // Get the kernel reading ahead while the first sections are copied
+    meshFile.prefetch();
 
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
-    {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-            return i;
-    }
+    // No intermediate copy : the uploader reads the mapping directly into staging (or into the buffer itself)
+    for (uint32_t stream = 0; stream < Vertex::Layout::BindingCount; stream++)
+        _vertexBuffers[stream] = _device.uploader().createBuffer(meshFile.streamData(stream), meshFile.streamSize(stream), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
 
-    throw std::runtime_error("failed to find suitable memory type!");
+    _indexBuffer = _device.uploader().createBuffer(meshFile.indexData(), meshFile.indexSize(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                                                   VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT);
 }
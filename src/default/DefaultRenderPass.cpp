@@ -2,6 +2,11 @@
 #include <Device.hpp>
 #include <SwapChain.hpp>
 
+#include <array>
+
+const uint32_t DefaultRenderPass::SceneSubpass = 0;
+const uint32_t DefaultRenderPass::OverlaySubpass = 1;
+
 void DefaultRenderPass::createRenderPass()
 {
     VkAttachmentDescription colorAttachment{};
@@ -25,17 +30,22 @@ void DefaultRenderPass::createRenderPass()
     colorAttachmentRef.attachment = 0;
     colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-    // Create subpass
-    VkSubpassDescription subpass{};
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    // Only 1 color attacment
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &colorAttachmentRef;
+    // Create subpasses : scene then overlay, both writing the same attachment
+    std::array<VkSubpassDescription, 2> subpasses{};
+    for (VkSubpassDescription &subpass : subpasses)
+    {
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        // Only 1 color attacment
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &colorAttachmentRef;
+    }
+
+    std::array<VkSubpassDependency, 2> dependencies{};
 
-    // Dependencies for the subpass
-    VkSubpassDependency dependency{};
+    // Dependencies for the scene subpass
+    VkSubpassDependency &dependency = dependencies[0];
     dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependency.dstSubpass = 0;
+    dependency.dstSubpass = SceneSubpass;
     // Wait for swapchain to finish reading the image
     dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     dependency.srcAccessMask = 0;
@@ -43,24 +53,40 @@ void DefaultRenderPass::createRenderPass()
     dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
+    // Overlays blend over the scene : only the same pixel is needed, so tilers never flush to memory in between
+    VkSubpassDependency &overlayDependency = dependencies[1];
+    overlayDependency.srcSubpass = SceneSubpass;
+    overlayDependency.dstSubpass = OverlaySubpass;
+    overlayDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    overlayDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    overlayDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    overlayDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    overlayDependency.dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
     // Finally, create actual render pass
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassInfo.attachmentCount = 1;
     renderPassInfo.pAttachments = &colorAttachment;
-    renderPassInfo.subpassCount = 1;
-    renderPassInfo.pSubpasses = &subpass;
+    renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+    renderPassInfo.pSubpasses = subpasses.data();
     // Add dependencies
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
+    renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+    renderPassInfo.pDependencies = dependencies.data();
 
     if (vkCreateRenderPass(_device.logical(), &renderPassInfo, nullptr, &_renderPass) != VK_SUCCESS)
     {
         throw std::runtime_error("failed to create render pass!");
     }
 }
-DefaultRenderPass::DefaultRenderPass(const Device &device, const SwapChain &swapChain) : RenderPass(device, swapChain)
+DefaultRenderPass::DefaultRenderPass(const Device &device, const SwapChain &swapChain, bool dynamic) : RenderPass(device, swapChain, dynamic)
 {
+    _format = _swapChain.imageFormat();
+
+    // Dynamic rendering needs neither
+    if (_dynamic)
+        return;
+
     createRenderPass();
     createFrameBuffers();
 }
\ No newline at end of file
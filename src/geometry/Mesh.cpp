@@ -0,0 +1,69 @@
+#include <geometry/Mesh.hpp>
+#include <geometry/MeshOptimizer.hpp>
+
+#include <cstring>
+
+VkIndexType Mesh::indexType() const
+{
+    // Without primitive restart, 0xFFFF is a regular index, so 65536 vertices still fit
+    return vertices.size() <= 0x10000 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+
+size_t Mesh::indexSize() const
+{
+    return indexType() == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+std::vector<uint8_t> Mesh::packedIndices() const
+{
+    std::vector<uint8_t> packed(indices.size() * indexSize());
+
+    if (indexType() == VK_INDEX_TYPE_UINT32)
+    {
+        memcpy(packed.data(), indices.data(), packed.size());
+        return packed;
+    }
+
+    uint16_t *narrow = reinterpret_cast<uint16_t *>(packed.data());
+    for (size_t i = 0; i < indices.size(); i++)
+        narrow[i] = static_cast<uint16_t>(indices[i]);
+
+    return packed;
+}
+
+uint32_t MeshBuilder::addVertex(const Vertex &vertex)
+{
+    auto [it, inserted] = _lookup.emplace(vertex, static_cast<uint32_t>(_mesh.vertices.size()));
+    if (inserted)
+        _mesh.vertices.push_back(vertex);
+
+    return it->second;
+}
+
+void MeshBuilder::addTriangle(const Vertex &a, const Vertex &b, const Vertex &c)
+{
+    _mesh.indices.push_back(addVertex(a));
+    _mesh.indices.push_back(addVertex(b));
+    _mesh.indices.push_back(addVertex(c));
+}
+
+void MeshBuilder::addTriangles(const std::vector<Vertex> &triangles)
+{
+    _lookup.reserve(_lookup.size() + triangles.size());
+    _mesh.indices.reserve(_mesh.indices.size() + triangles.size());
+
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+        addTriangle(triangles[i], triangles[i + 1], triangles[i + 2]);
+}
+
+Mesh MeshBuilder::build(bool optimize)
+{
+    Mesh mesh = std::move(_mesh);
+    _mesh = Mesh{};
+    _lookup.clear();
+
+    if (optimize)
+        MeshOptimizer::Optimize(mesh);
+
+    return mesh;
+}
@@ -0,0 +1,273 @@
+#include <geometry/MeshFile.hpp>
+#include <geometry/MeshOptimizer.hpp>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+const char MeshFile::Magic[4] = {'V', 'K', 'B', 'M'};
+const uint32_t MeshFile::Version = 2;
+const uint64_t MeshFile::SectionAlignment = 64;
+
+MappedFile::MappedFile(const std::string &path) : _data(nullptr),
+                                                  _size(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Failed to open " + path + "!");
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        throw std::runtime_error("Failed to stat " + path + ", or the file is empty!");
+    }
+    _size = static_cast<size_t>(info.st_size);
+
+    void *data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+
+    if (data == MAP_FAILED)
+        throw std::runtime_error("Failed to map " + path + "!");
+    _data = data;
+}
+
+MappedFile::~MappedFile()
+{
+    if (_data != nullptr)
+        munmap(const_cast<void *>(_data), _size);
+}
+
+void MappedFile::willRead(size_t offset, size_t size) const
+{
+    // madvise wants a page aligned start
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t start = offset / page * page;
+    char *base = static_cast<char *>(const_cast<void *>(_data));
+
+    madvise(base + start, offset + size - start, MADV_SEQUENTIAL);
+    madvise(base + start, offset + size - start, MADV_WILLNEED);
+}
+
+/// @brief Largest of `count` indices of type `T` starting at `data`, 0 if there is none
+template <typename T>
+static uint32_t MaxIndex(const void *data, uint32_t first, uint32_t count)
+{
+    const T *indices = static_cast<const T *>(data) + first;
+
+    uint32_t max = 0;
+    for (uint32_t i = 0; i < count; i++)
+        max = std::max<uint32_t>(max, indices[i]);
+    return max;
+}
+
+MeshFile::MeshFile(const std::string &path) : _file(path)
+{
+    if (_file.size() < sizeof(Header))
+        throw std::runtime_error(path + " is too small to be a cooked mesh!");
+
+    _header = static_cast<const Header *>(_file.data());
+    if (memcmp(_header->magic, Magic, sizeof(Magic)) != 0 || _header->version != Version)
+        throw std::runtime_error(path + " is not a cooked mesh, or was cooked by another version!");
+
+    // Data is packed for one vertex layout only : re-cook when it changes
+    if (_header->layoutHash != LayoutHash() || _header->streamCount != Vertex::Layout::BindingCount)
+        throw std::runtime_error(path + " was cooked for another vertex layout!");
+
+    uint64_t tableSize = (_header->streamCount + 3) * sizeof(Section);
+    if (_file.size() < sizeof(Header) + tableSize)
+        throw std::runtime_error(path + " has a truncated section table!");
+
+    _streams = reinterpret_cast<const Section *>(static_cast<const char *>(_file.data()) + sizeof(Header));
+    _indices = _streams[_header->streamCount];
+    _bounds = _streams[_header->streamCount + 1];
+    _lods = _streams[_header->streamCount + 2];
+
+    for (uint32_t stream = 0; stream < _header->streamCount; stream++)
+        checkSection(_streams[stream], uint64_t(_header->vertexCount) * Vertex::Layout::Bindings[stream].stride, "vertex stream");
+
+    if (_header->indexType != VK_INDEX_TYPE_UINT16 && _header->indexType != VK_INDEX_TYPE_UINT32)
+        throw std::runtime_error("Cooked mesh has an unknown index type!");
+    uint64_t indexWidth = _header->indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    checkSection(_indices, _header->indexCount * indexWidth, "index");
+
+    checkSection(_bounds, _header->boundsCount * sizeof(MeshBounds), "bounds");
+    checkSection(_lods, _header->lodCount * sizeof(MeshLod), "LOD");
+
+    for (uint32_t i = 0; i < lodCount(); i++)
+    {
+        const MeshLod &level = lod(i);
+        if (uint64_t(level.firstIndex) + level.indexCount > indexCount() || level.boundsIndex >= boundsCount())
+            throw std::runtime_error("Cooked mesh has a LOD out of range!");
+
+        // An index past the vertices would have the GPU fetch out of the vertex buffers
+        if (level.indexCount == 0)
+            continue;
+        uint32_t maxIndex = indexType() == VK_INDEX_TYPE_UINT16 ? MaxIndex<uint16_t>(indexData(), level.firstIndex, level.indexCount)
+                                                                : MaxIndex<uint32_t>(indexData(), level.firstIndex, level.indexCount);
+        if (maxIndex >= vertexCount())
+            throw std::runtime_error("Cooked mesh has an index out of range in LOD " + std::to_string(i) + "!");
+    }
+}
+
+bool MeshFile::UpToDate(const std::string &path, uint64_t sourceHash)
+{
+    std::ifstream file(path, std::ios::binary);
+    Header header;
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        return false;
+
+    return memcmp(header.magic, Magic, sizeof(Magic)) == 0 && header.version == Version &&
+           header.layoutHash == LayoutHash() && header.sourceHash == sourceHash;
+}
+
+uint64_t MeshFile::Hash(const void *data, size_t size, uint64_t hash)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return hash;
+}
+
+uint64_t MeshFile::LayoutHash()
+{
+    // Plain arrays of 32 bit fields, no padding to hash
+    uint64_t hash = Hash(Vertex::Layout::Bindings.data(), sizeof(Vertex::Layout::Bindings));
+    return Hash(Vertex::Layout::Attributes.data(), sizeof(Vertex::Layout::Attributes), hash);
+}
+
+void MeshFile::checkSection(const Section &section, uint64_t expectedSize, const char *name) const
+{
+    if (section.size != expectedSize || section.offset % SectionAlignment != 0 ||
+        section.offset > _file.size() || section.size > _file.size() - section.offset)
+        throw std::runtime_error(std::string("Cooked mesh has a corrupted ") + name + " section!");
+}
+
+void MeshFile::prefetch() const
+{
+    // Sections are laid out back to back, so it's one sequential read
+    uint64_t start = _streams[0].offset;
+    _file.willRead(start, _file.size() - start);
+}
+
+static MeshBounds ComputeBounds(const Mesh &mesh, const std::vector<uint32_t> &indices)
+{
+    MeshBounds bounds{};
+    if (indices.empty())
+        return bounds;
+
+    glm::vec3 min = mesh.vertices[indices[0]].pos, max = min;
+    for (uint32_t index : indices)
+    {
+        min = glm::min(min, mesh.vertices[index].pos);
+        max = glm::max(max, mesh.vertices[index].pos);
+    }
+
+    glm::vec3 center = (min + max) * 0.5f;
+    float radius = 0.0f;
+    for (uint32_t index : indices)
+        radius = std::max(radius, glm::length(mesh.vertices[index].pos - center));
+
+    for (int i = 0; i < 3; i++)
+    {
+        bounds.min[i] = min[i];
+        bounds.max[i] = max[i];
+        bounds.center[i] = center[i];
+    }
+    bounds.radius = radius;
+    return bounds;
+}
+
+void MeshFile::Write(const std::string &path, const Mesh &mesh, uint64_t sourceHash, const std::vector<std::vector<uint32_t>> &lods, const std::vector<float> &lodErrors)
+{
+    // LOD 0 is written as given : MeshBuilder::build() already optimised it, vertex order included, and a mesh built
+    // without it is left alone on purpose. The coarser LODs go through the cache optimiser, over LOD 0's vertices
+    std::vector<std::vector<uint32_t>> levels;
+    levels.push_back(mesh.indices);
+    for (const auto &lod : lods)
+    {
+        levels.push_back(lod);
+        MeshOptimizer::OptimizeVertexCache(levels.back(), mesh.vertices.size());
+    }
+
+    Header header{};
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+    header.indexType = mesh.indexType();
+    header.streamCount = Vertex::Layout::BindingCount;
+    header.boundsCount = static_cast<uint32_t>(levels.size());
+    header.lodCount = static_cast<uint32_t>(levels.size());
+    header.layoutHash = LayoutHash();
+    header.sourceHash = sourceHash;
+
+    std::vector<MeshBounds> bounds;
+    std::vector<MeshLod> lodTable;
+    std::vector<uint8_t> indices;
+    for (const auto &level : levels)
+    {
+        MeshLod lod{};
+        lod.firstIndex = header.indexCount;
+        lod.indexCount = static_cast<uint32_t>(level.size());
+        lod.boundsIndex = static_cast<uint32_t>(bounds.size());
+        if (lodTable.size() > 0 && lodTable.size() - 1 < lodErrors.size())
+            lod.error = lodErrors[lodTable.size() - 1];
+        lodTable.push_back(lod);
+
+        bounds.push_back(ComputeBounds(mesh, level));
+
+        // Same width as LOD 0, the vertex count is shared
+        for (uint32_t index : level)
+        {
+            if (header.indexType == VK_INDEX_TYPE_UINT16)
+            {
+                uint16_t narrow = static_cast<uint16_t>(index);
+                indices.insert(indices.end(), reinterpret_cast<uint8_t *>(&narrow), reinterpret_cast<uint8_t *>(&narrow) + sizeof(narrow));
+            }
+            else
+                indices.insert(indices.end(), reinterpret_cast<uint8_t *>(&index), reinterpret_cast<uint8_t *>(&index) + sizeof(index));
+        }
+        header.indexCount += lod.indexCount;
+    }
+
+    std::vector<std::vector<uint8_t>> sections;
+    for (uint32_t stream = 0; stream < Vertex::Layout::BindingCount; stream++)
+        sections.push_back(Vertex::PackStream(mesh.vertices, stream));
+    sections.push_back(std::move(indices));
+    sections.emplace_back(reinterpret_cast<const uint8_t *>(bounds.data()), reinterpret_cast<const uint8_t *>(bounds.data() + bounds.size()));
+    sections.emplace_back(reinterpret_cast<const uint8_t *>(lodTable.data()), reinterpret_cast<const uint8_t *>(lodTable.data() + lodTable.size()));
+
+    // Place the sections after the header and table, each one aligned
+    std::vector<Section> table(sections.size());
+    uint64_t offset = sizeof(Header) + table.size() * sizeof(Section);
+    for (size_t i = 0; i < sections.size(); i++)
+    {
+        offset = (offset + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+        table[i] = {offset, sections[i].size()};
+        offset += sections[i].size();
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("Failed to open " + path + " for writing!");
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(Section));
+    for (size_t i = 0; i < sections.size(); i++)
+    {
+        // Zero padding up to the section start
+        static const char zeros[64] = {};
+        file.write(zeros, table[i].offset - static_cast<uint64_t>(file.tellp()));
+        file.write(reinterpret_cast<const char *>(sections[i].data()), sections[i].size());
+    }
+
+    if (!file)
+        throw std::runtime_error("Failed to write " + path + "!");
+}
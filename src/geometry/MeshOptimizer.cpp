@@ -0,0 +1,306 @@
+#include <geometry/MeshOptimizer.hpp>
+#include <geometry/Mesh.hpp>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+const uint32_t MeshOptimizer::CacheSize = 32;
+
+// Scoring constants from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+static const float CacheDecayPower = 1.5f;
+static const float LastTriScore = 0.75f;
+static const float ValenceBoostScale = 2.0f;
+static const float ValenceBoostPower = 0.5f;
+
+static float VertexScore(int cachePosition, uint32_t remainingTriangles)
+{
+    // Vertex not used anymore, it doesn't matter where it goes
+    if (remainingTriangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        // The 3 vertices of the last triangle get a fixed score, so that strips don't go backwards
+        if (cachePosition < 3)
+            score = LastTriScore;
+        else
+        {
+            float scaler = 1.0f / (MeshOptimizer::CacheSize - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scaler, CacheDecayPower);
+        }
+    }
+
+    // Boost vertices with few triangles left, so that lone triangles are not left behind
+    score += ValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -ValenceBoostPower);
+    return score;
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // Vertex -> triangles adjacency, as offsets into a flat list
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (uint32_t index : indices)
+        remaining[index]++;
+
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+        offsets[v + 1] = offsets[v] + remaining[v];
+
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < triangleCount; t++)
+            for (size_t k = 0; k < 3; k++)
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        vertexScore[v] = VertexScore(-1, remaining[v]);
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; t++)
+        triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+    std::vector<uint32_t> cache, newCache;
+    cache.reserve(CacheSize + 3);
+    newCache.reserve(CacheSize + 3);
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+
+    size_t bestTriangle = std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin();
+    size_t cursor = 0;
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+    {
+        // Nothing useful in the cache : take the next triangle not emitted yet
+        if (bestTriangle == triangleCount)
+        {
+            while (emitted[cursor])
+                cursor++;
+            bestTriangle = cursor;
+        }
+
+        const uint32_t *tri = &indices[bestTriangle * 3];
+        output.insert(output.end(), tri, tri + 3);
+        emitted[bestTriangle] = true;
+
+        // Remove the triangle from its vertices' remaining lists
+        for (size_t k = 0; k < 3; k++)
+        {
+            uint32_t v = tri[k];
+            uint32_t *begin = &adjacency[offsets[v]];
+            uint32_t *end = begin + remaining[v];
+            uint32_t *it = std::find(begin, end, static_cast<uint32_t>(bestTriangle));
+            std::swap(*it, *(end - 1));
+            remaining[v]--;
+        }
+
+        // Triangle vertices go to the front of the LRU cache
+        newCache.assign(tri, tri + 3);
+        for (uint32_t v : cache)
+            if (v != tri[0] && v != tri[1] && v != tri[2])
+                newCache.push_back(v);
+
+        // Update positions, scores of touched vertices and of their triangles
+        for (size_t i = 0; i < newCache.size(); i++)
+        {
+            uint32_t v = newCache[i];
+            cachePosition[v] = i < CacheSize ? static_cast<int>(i) : -1;
+            vertexScore[v] = VertexScore(cachePosition[v], remaining[v]);
+        }
+
+        bestTriangle = triangleCount;
+        float bestScore = -1.0f;
+        for (uint32_t v : newCache)
+        {
+            for (uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; a++)
+            {
+                uint32_t t = adjacency[a];
+                const uint32_t *other = &indices[t * 3];
+                triangleScore[t] = vertexScore[other[0]] + vertexScore[other[1]] + vertexScore[other[2]];
+
+                if (triangleScore[t] > bestScore)
+                {
+                    bestScore = triangleScore[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        // Anything past the real cache size has been evicted
+        if (newCache.size() > CacheSize)
+            newCache.resize(CacheSize);
+        std::swap(cache, newCache);
+    }
+
+    indices.swap(output);
+}
+
+float MeshOptimizer::AverageCacheMissRatio(const std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize)
+{
+    if (indices.size() < 3)
+        return 0.0f;
+
+    // FIFO cache, as implemented by most hardware : timestamps tell whether a vertex is still inside
+    std::vector<size_t> insertedAt(vertexCount, 0);
+    size_t time = cacheSize + 1;
+    size_t misses = 0;
+
+    for (uint32_t index : indices)
+    {
+        if (time - insertedAt[index] > cacheSize)
+        {
+            insertedAt[index] = time++;
+            misses++;
+        }
+    }
+
+    return static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t> &indices, const float *positions, size_t vertexCount, size_t stride, float threshold)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2)
+        return;
+
+    auto position = [&](uint32_t index)
+    {
+        const float *p = reinterpret_cast<const float *>(reinterpret_cast<const char *>(positions) + index * stride);
+        return glm::vec3(p[0], p[1], p[2]);
+    };
+
+    // Cut clusters where a triangle misses the cache on all 3 vertices : the cache is cold there anyway
+    std::vector<size_t> clusters;
+    {
+        std::vector<size_t> insertedAt(vertexCount, 0);
+        size_t time = 16 + 1;
+
+        for (size_t t = 0; t < triangleCount; t++)
+        {
+            uint32_t misses = 0;
+            for (size_t k = 0; k < 3; k++)
+            {
+                uint32_t index = indices[t * 3 + k];
+                if (time - insertedAt[index] > 16)
+                {
+                    insertedAt[index] = time++;
+                    misses++;
+                }
+            }
+
+            if (t == 0 || misses == 3)
+                clusters.push_back(t);
+        }
+    }
+
+    if (clusters.size() < 2)
+        return;
+
+    // Mesh centroid, area weighted
+    glm::vec3 meshCentroid(0.0f);
+    float meshArea = 0.0f;
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        glm::vec3 a = position(indices[t * 3]), b = position(indices[t * 3 + 1]), c = position(indices[t * 3 + 2]);
+        float area = glm::length(glm::cross(b - a, c - a));
+        meshCentroid += (a + b + c) * (area / 3.0f);
+        meshArea += area;
+    }
+    if (meshArea > 0.0f)
+        meshCentroid = meshCentroid / meshArea;
+
+    // Clusters facing away from the centroid are likely occluders : sort them first
+    std::vector<float> sortKey(clusters.size());
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        size_t begin = clusters[c];
+        size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = begin; t < end; t++)
+        {
+            glm::vec3 a = position(indices[t * 3]), b = position(indices[t * 3 + 1]), c3 = position(indices[t * 3 + 2]);
+            glm::vec3 n = glm::cross(b - a, c3 - a);
+            float triangleArea = glm::length(n);
+            centroid += (a + b + c3) * (triangleArea / 3.0f);
+            normal += n;
+            area += triangleArea;
+        }
+
+        if (area > 0.0f)
+            centroid = centroid / area;
+        float normalLength = glm::length(normal);
+        if (normalLength > 0.0f)
+            normal = normal / normalLength;
+
+        sortKey[c] = glm::dot(centroid - meshCentroid, normal);
+    }
+
+    std::vector<size_t> order(clusters.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+                     { return sortKey[a] > sortKey[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (size_t c : order)
+    {
+        size_t begin = clusters[c];
+        size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+        output.insert(output.end(), indices.begin() + begin * 3, indices.begin() + end * 3);
+    }
+
+    // Only keep the new order if it doesn't cost too many vertex shader invocations
+    if (AverageCacheMissRatio(output, vertexCount) <= AverageCacheMissRatio(indices, vertexCount) * threshold)
+        indices.swap(output);
+}
+
+size_t MeshOptimizer::OptimizeVertexFetch(void *vertices, size_t vertexCount, size_t stride, std::vector<uint32_t> &indices)
+{
+    const uint32_t unused = ~0u;
+    std::vector<uint32_t> remap(vertexCount, unused);
+    uint32_t next = 0;
+
+    for (uint32_t &index : indices)
+    {
+        if (remap[index] == unused)
+            remap[index] = next++;
+        index = remap[index];
+    }
+
+    // Move the vertices to their new slot through a copy, the permutation can't easily be done in place
+    std::vector<char> copy(static_cast<char *>(vertices), static_cast<char *>(vertices) + vertexCount * stride);
+    for (size_t v = 0; v < vertexCount; v++)
+        if (remap[v] != unused)
+            memcpy(static_cast<char *>(vertices) + remap[v] * stride, copy.data() + v * stride, stride);
+
+    return next;
+}
+
+void MeshOptimizer::Optimize(Mesh &mesh)
+{
+    if (mesh.indices.empty())
+        return;
+
+    // Cache first, overdraw reorders whole clusters of it, and fetch follows the final index order
+    OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+    OptimizeOverdraw(mesh.indices, &mesh.vertices[0].pos.x, mesh.vertices.size(), sizeof(Vertex));
+
+    size_t vertexCount = OptimizeVertexFetch(mesh.vertices.data(), mesh.vertices.size(), sizeof(Vertex), mesh.indices);
+    mesh.vertices.resize(vertexCount);
+}
@@ -1,30 +1,42 @@
 #include <geometry/Vertex.hpp>
 
-VkVertexInputBindingDescription Vertex::getBindingDescription()
+uint32_t Vertex::StreamStride(uint32_t stream)
 {
-    VkVertexInputBindingDescription bindingDescription{};
-    bindingDescription.binding = 0;
-    bindingDescription.stride = sizeof(Vertex);
-    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    switch (stream)
+    {
+    case 0:
+        return PositionStream::Stride;
+    case 1:
+        return ShadingStream::Stride;
+    default:
+        throw std::runtime_error("Vertex layout has no such stream!");
+    }
+}
 
-    return bindingDescription;
+std::vector<uint8_t> Vertex::PackStream(const std::vector<Vertex> &vertices, uint32_t stream)
+{
+    std::vector<uint8_t> packed(vertices.size() * StreamStride(stream));
+    PackStream(vertices, stream, packed.data());
+    return packed;
 }
 
-std::array<VkVertexInputAttributeDescription, 2> Vertex::getAttributeDescriptions()
+void Vertex::PackStream(const std::vector<Vertex> &vertices, uint32_t stream, void *dst)
 {
-    std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
+    uint8_t *bytes = static_cast<uint8_t *>(dst);
 
-    // The vertex shader's first attribute is the vertex position, a vec3()
-    attributeDescriptions[0].binding = 0;
-    attributeDescriptions[0].location = 0;
-    attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[0].offset = offsetof(Vertex, pos);
+    switch (stream)
+    {
+    case 0:
+        for (size_t i = 0; i < vertices.size(); i++)
+            PositionStream::Write<0>(bytes + i * PositionStream::Stride, vertices[i].pos);
+        break;
 
-    // The second attribute is the color, another vec3()
-    attributeDescriptions[1].binding = 0;
-    attributeDescriptions[1].location = 1;
-    attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-    attributeDescriptions[1].offset = offsetof(Vertex, color);
+    case 1:
+        for (size_t i = 0; i < vertices.size(); i++)
+            ShadingStream::Write<0>(bytes + i * ShadingStream::Stride, VertexPacking::Unorm8x4(glm::vec4(vertices[i].color, 1.0f)));
+        break;
 
-    return attributeDescriptions;
-}
\ No newline at end of file
+    default:
+        throw std::runtime_error("Vertex layout has no such stream!");
+    }
+}
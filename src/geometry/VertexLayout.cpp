@@ -0,0 +1,109 @@
+#include <geometry/VertexLayout.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+static int32_t QuantizeSnorm(float value, uint32_t bits)
+{
+    float scale = static_cast<float>((1 << (bits - 1)) - 1);
+    return static_cast<int32_t>(std::round(std::clamp(value, -1.0f, 1.0f) * scale));
+}
+
+static uint32_t QuantizeUnorm(float value, uint32_t bits)
+{
+    float scale = static_cast<float>((1u << bits) - 1);
+    return static_cast<uint32_t>(std::round(std::clamp(value, 0.0f, 1.0f) * scale));
+}
+
+uint16_t VertexPacking::Half(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    uint32_t exponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    // NaN stays NaN, infinity stays infinity
+    if (exponent == 0xFF)
+        return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+
+    int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+
+    // Too big : infinity
+    if (halfExponent >= 0x1F)
+        return sign | 0x7C00;
+
+    // Too small for a normal half : denormal or zero
+    if (halfExponent <= 0)
+    {
+        if (halfExponent < -10)
+            return sign;
+
+        mantissa |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1)))
+            half++;
+        return sign | static_cast<uint16_t>(half);
+    }
+
+    uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFF;
+    // A carry out of the mantissa correctly bumps the exponent, up to infinity
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        half++;
+    return sign | static_cast<uint16_t>(half);
+}
+
+std::array<uint16_t, 2> VertexPacking::Half2(glm::vec2 value)
+{
+    return {Half(value.x), Half(value.y)};
+}
+
+std::array<uint16_t, 4> VertexPacking::Half4(glm::vec4 value)
+{
+    return {Half(value.x), Half(value.y), Half(value.z), Half(value.w)};
+}
+
+std::array<int16_t, 2> VertexPacking::Snorm16x2(glm::vec2 value)
+{
+    return {static_cast<int16_t>(QuantizeSnorm(value.x, 16)), static_cast<int16_t>(QuantizeSnorm(value.y, 16))};
+}
+
+std::array<int16_t, 4> VertexPacking::Snorm16x4(glm::vec4 value)
+{
+    return {static_cast<int16_t>(QuantizeSnorm(value.x, 16)), static_cast<int16_t>(QuantizeSnorm(value.y, 16)),
+            static_cast<int16_t>(QuantizeSnorm(value.z, 16)), static_cast<int16_t>(QuantizeSnorm(value.w, 16))};
+}
+
+uint32_t VertexPacking::Snorm8x4(glm::vec4 value)
+{
+    // Components are laid out R first in memory, which is the low byte on little endian hosts
+    uint32_t packed = 0;
+    for (int i = 0; i < 4; i++)
+        packed |= (static_cast<uint32_t>(QuantizeSnorm(value[i], 8)) & 0xFF) << (8 * i);
+    return packed;
+}
+
+uint32_t VertexPacking::Unorm8x4(glm::vec4 value)
+{
+    uint32_t packed = 0;
+    for (int i = 0; i < 4; i++)
+        packed |= QuantizeUnorm(value[i], 8) << (8 * i);
+    return packed;
+}
+
+uint32_t VertexPacking::Unorm10x3(glm::vec3 value, bool isSigned)
+{
+    // A2B10G10R10 : R in the low bits, alpha left at 0
+    uint32_t packed = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        float component = isSigned ? value[i] * 0.5f + 0.5f : value[i];
+        packed |= QuantizeUnorm(component, 10) << (10 * i);
+    }
+    return packed;
+}
@@ -0,0 +1,323 @@
+#include <memory/Allocator.hpp>
+#include <Device.hpp>
+
+#include <algorithm>
+#include <bit>
+
+const VkDeviceSize Allocator::DefaultBlockSize = 64ull * 1024 * 1024;
+
+Allocator::Allocator(const Device &device) : _device(device), _memoryTypes(device.memoryTypes()), _allocationCount(0)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(_device.physical(), &properties);
+    _bufferImageGranularity = properties.limits.bufferImageGranularity;
+    _maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+
+    _heapStats.reset(new HeapCounters[heapCount()]);
+}
+
+Allocator::~Allocator()
+{
+    for (auto &[key, pool] : _pools)
+        for (auto &block : pool.blocks)
+        {
+            if (block->mapped() != nullptr)
+                vkUnmapMemory(_device.logical(), block->memory());
+            vkFreeMemory(_device.logical(), block->memory(), nullptr);
+        }
+}
+
+VkDeviceSize Allocator::blockSize(uint32_t memoryType) const
+{
+    // Small heaps (integrated GPUs, BAR windows...) get smaller blocks so that one block doesn't eat them whole
+    VkDeviceSize heapSize = memoryProperties().memoryHeaps[_memoryTypes.heapIndex(memoryType)].size;
+    if (heapSize <= 1024ull * 1024 * 1024)
+        return std::bit_floor(heapSize / 8);
+
+    return DefaultBlockSize;
+}
+
+uint64_t Allocator::poolKey(uint32_t memoryType, AllocationStrategy strategy, bool optimalTiling) const
+{
+    // Linear and optimal resources only need to be kept apart when the device has a granularity constraint.
+    // Keeping them in separate blocks is cheaper than checking neighbours on every allocation.
+    uint64_t tiling = (_bufferImageGranularity > 1 && optimalTiling) ? 1 : 0;
+    return (uint64_t(memoryType) << 8) | (uint64_t(strategy) << 1) | tiling;
+}
+
+MemoryBlock *Allocator::createBlock(uint32_t memoryType, VkDeviceSize size, AllocationStrategy strategy)
+{
+    if (_allocationCount >= _maxAllocationCount)
+        throw std::runtime_error("Reached maxMemoryAllocationCount!");
+
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(_device.logical(), &allocInfo, nullptr, &memory) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate memory block!");
+
+    // Host visible blocks stay mapped for their whole lifetime, no map/unmap per resource
+    void *mapped = nullptr;
+    if (_memoryTypes.flags(memoryType) & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        vkMapMemory(_device.logical(), memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+
+    _allocationCount++;
+    auto &stats = _heapStats[_memoryTypes.heapIndex(memoryType)];
+    stats.blockBytes.fetch_add(size, std::memory_order_relaxed);
+    stats.blockCount.fetch_add(1, std::memory_order_relaxed);
+
+    switch (strategy)
+    {
+    case AllocationStrategy::Linear:
+        return new LinearBlock(memory, size, memoryType, mapped);
+    case AllocationStrategy::Buddy:
+        return new BuddyBlock(memory, size, memoryType, mapped);
+    default:
+        return new FreeListBlock(memory, size, memoryType, mapped);
+    }
+}
+
+void Allocator::destroyBlock(MemoryBlock *block)
+{
+    auto &stats = _heapStats[_memoryTypes.heapIndex(block->memoryType())];
+    stats.blockBytes.fetch_sub(block->size(), std::memory_order_relaxed);
+    stats.blockCount.fetch_sub(1, std::memory_order_relaxed);
+    _allocationCount--;
+
+    if (block->mapped() != nullptr)
+        vkUnmapMemory(_device.logical(), block->memory());
+    vkFreeMemory(_device.logical(), block->memory(), nullptr);
+}
+
+Allocation Allocator::allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties, AllocationStrategy strategy, bool optimalTiling)
+{
+    return allocateFromType(requirements, _memoryTypes.find(requirements.memoryTypeBits, properties), strategy, optimalTiling);
+}
+
+Allocation Allocator::allocate(const VkMemoryRequirements &requirements, MemoryUsage usage, AllocationStrategy strategy, bool optimalTiling)
+{
+    return allocateFromType(requirements, _memoryTypes.find(requirements.memoryTypeBits, usage), strategy, optimalTiling);
+}
+
+Allocation Allocator::allocateFromType(const VkMemoryRequirements &requirements, uint32_t memoryType, AllocationStrategy strategy, bool optimalTiling)
+{
+    Allocation allocation;
+    allocation.memoryType = memoryType;
+    allocation.size = requirements.size;
+    allocation.pool = poolKey(allocation.memoryType, strategy, optimalTiling);
+
+    auto &pool = _pools[allocation.pool];
+
+    VkDeviceSize offset = 0;
+    for (auto &block : pool.blocks)
+    {
+        if (block->allocate(requirements.size, requirements.alignment, offset))
+        {
+            allocation.block = block.get();
+            break;
+        }
+    }
+
+    if (allocation.block == nullptr)
+    {
+        // Big resources get a block of their own instead of wasting most of a shared one
+        VkDeviceSize size = blockSize(allocation.memoryType);
+        if (requirements.size > size / 2)
+            size = requirements.size;
+        if (strategy == AllocationStrategy::Buddy)
+            size = BuddyBlock::NextPowerOfTwo(size);
+
+        pool.blocks.emplace_back(createBlock(allocation.memoryType, size, strategy));
+        allocation.block = pool.blocks.back().get();
+
+        if (!allocation.block->allocate(requirements.size, requirements.alignment, offset))
+            throw std::runtime_error("failed to sub-allocate from a fresh memory block!");
+    }
+
+    allocation.memory = allocation.block->memory();
+    allocation.offset = offset;
+    if (allocation.block->mapped() != nullptr)
+        allocation.mapped = static_cast<char *>(allocation.block->mapped()) + offset;
+
+    auto &stats = _heapStats[_memoryTypes.heapIndex(allocation.memoryType)];
+    stats.allocatedBytes.fetch_add(allocation.size, std::memory_order_relaxed);
+    stats.allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    return allocation;
+}
+
+void Allocator::free(Allocation &allocation)
+{
+    if (allocation.block == nullptr)
+        return;
+
+    auto &stats = _heapStats[_memoryTypes.heapIndex(allocation.memoryType)];
+    stats.allocatedBytes.fetch_sub(allocation.size, std::memory_order_relaxed);
+    stats.allocationCount.fetch_sub(1, std::memory_order_relaxed);
+
+    MemoryBlock *block = allocation.block;
+    block->free(allocation.offset, allocation.size);
+
+    // Give empty blocks back to the driver, except a single regular one per pool to avoid churn
+    auto &pool = _pools[allocation.pool];
+    if (block->empty() && (pool.blocks.size() > 1 || block->size() > blockSize(block->memoryType())))
+    {
+        for (auto it = pool.blocks.begin(); it != pool.blocks.end(); ++it)
+        {
+            if (it->get() == block)
+            {
+                destroyBlock(block);
+                pool.blocks.erase(it);
+                break;
+            }
+        }
+    }
+
+    allocation = Allocation{};
+}
+
+VkMappedMemoryRange Allocator::mappedRange(const Allocation &allocation, VkDeviceSize offset, VkDeviceSize size) const
+{
+    // Ranges must be aligned to nonCoherentAtomSize, relative to the start of the VkDeviceMemory
+    VkDeviceSize atom = _memoryTypes.nonCoherentAtomSize();
+    VkDeviceSize end = size == VK_WHOLE_SIZE ? allocation.size : offset + size;
+    VkDeviceSize begin = allocation.offset + offset;
+
+    VkMappedMemoryRange range{};
+    range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+    range.memory = allocation.memory;
+    range.offset = begin / atom * atom;
+    range.size = std::min(MemoryBlock::AlignUp(allocation.offset + end, atom), allocation.block->size()) - range.offset;
+
+    return range;
+}
+
+void Allocator::flush(const Allocation &allocation, VkDeviceSize offset, VkDeviceSize size) const
+{
+    if (allocation.mapped == nullptr || (_memoryTypes.flags(allocation.memoryType) & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+        return;
+
+    VkMappedMemoryRange range = mappedRange(allocation, offset, size);
+    vkFlushMappedMemoryRanges(_device.logical(), 1, &range);
+}
+
+void Allocator::invalidate(const Allocation &allocation, VkDeviceSize offset, VkDeviceSize size) const
+{
+    if (allocation.mapped == nullptr || (_memoryTypes.flags(allocation.memoryType) & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+        return;
+
+    VkMappedMemoryRange range = mappedRange(allocation, offset, size);
+    vkInvalidateMappedMemoryRanges(_device.logical(), 1, &range);
+}
+
+VkBuffer Allocator::createBufferHandle(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryRequirements &requirements)
+{
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VkBuffer handle;
+    if (vkCreateBuffer(_device.logical(), &bufferInfo, nullptr, &handle) != VK_SUCCESS)
+        throw std::runtime_error("failed to create buffer!");
+
+    vkGetBufferMemoryRequirements(_device.logical(), handle, &requirements);
+    return handle;
+}
+
+Buffer Allocator::bindBuffer(VkBuffer handle, VkDeviceSize size, const VkMemoryRequirements &requirements, uint32_t memoryType, AllocationStrategy strategy)
+{
+    Buffer buffer;
+    buffer.handle = handle;
+    buffer.size = size;
+    buffer.allocation = allocateFromType(requirements, memoryType, strategy, false);
+
+    if (vkBindBufferMemory(_device.logical(), buffer.handle, buffer.allocation.memory, buffer.allocation.offset) != VK_SUCCESS)
+        throw std::runtime_error("failed to bind buffer memory!");
+
+    return buffer;
+}
+
+Buffer Allocator::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, AllocationStrategy strategy)
+{
+    VkMemoryRequirements requirements;
+    VkBuffer handle = createBufferHandle(size, usage, requirements);
+    return bindBuffer(handle, size, requirements, _memoryTypes.find(requirements.memoryTypeBits, properties), strategy);
+}
+
+Buffer Allocator::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, MemoryUsage memoryUsage, AllocationStrategy strategy)
+{
+    VkMemoryRequirements requirements;
+    VkBuffer handle = createBufferHandle(size, usage, requirements);
+    return bindBuffer(handle, size, requirements, _memoryTypes.find(requirements.memoryTypeBits, memoryUsage), strategy);
+}
+
+void Allocator::destroyBuffer(Buffer &buffer)
+{
+    if (buffer.handle != VK_NULL_HANDLE)
+        vkDestroyBuffer(_device.logical(), buffer.handle, nullptr);
+    free(buffer.allocation);
+    buffer = Buffer{};
+}
+
+VkImage Allocator::createImageHandle(const VkImageCreateInfo &createInfo, VkMemoryRequirements &requirements)
+{
+    VkImage handle;
+    if (vkCreateImage(_device.logical(), &createInfo, nullptr, &handle) != VK_SUCCESS)
+        throw std::runtime_error("failed to create image!");
+
+    vkGetImageMemoryRequirements(_device.logical(), handle, &requirements);
+    return handle;
+}
+
+Image Allocator::bindImage(VkImage handle, const VkMemoryRequirements &requirements, uint32_t memoryType, AllocationStrategy strategy, bool optimalTiling)
+{
+    Image image;
+    image.handle = handle;
+    image.allocation = allocateFromType(requirements, memoryType, strategy, optimalTiling);
+
+    if (vkBindImageMemory(_device.logical(), image.handle, image.allocation.memory, image.allocation.offset) != VK_SUCCESS)
+        throw std::runtime_error("failed to bind image memory!");
+
+    return image;
+}
+
+Image Allocator::createImage(const VkImageCreateInfo &createInfo, VkMemoryPropertyFlags properties, AllocationStrategy strategy)
+{
+    VkMemoryRequirements requirements;
+    VkImage handle = createImageHandle(createInfo, requirements);
+    return bindImage(handle, requirements, _memoryTypes.find(requirements.memoryTypeBits, properties), strategy,
+                     createInfo.tiling == VK_IMAGE_TILING_OPTIMAL);
+}
+
+Image Allocator::createImage(const VkImageCreateInfo &createInfo, MemoryUsage memoryUsage, AllocationStrategy strategy)
+{
+    VkMemoryRequirements requirements;
+    VkImage handle = createImageHandle(createInfo, requirements);
+    return bindImage(handle, requirements, _memoryTypes.find(requirements.memoryTypeBits, memoryUsage), strategy,
+                     createInfo.tiling == VK_IMAGE_TILING_OPTIMAL);
+}
+
+void Allocator::destroyImage(Image &image)
+{
+    if (image.handle != VK_NULL_HANDLE)
+        vkDestroyImage(_device.logical(), image.handle, nullptr);
+    free(image.allocation);
+    image = Image{};
+}
+
+HeapStats Allocator::heapStats(uint32_t heap) const
+{
+    const HeapCounters &counters = _heapStats[heap];
+
+    HeapStats stats;
+    stats.blockBytes = counters.blockBytes.load(std::memory_order_relaxed);
+    stats.allocatedBytes = counters.allocatedBytes.load(std::memory_order_relaxed);
+    stats.blockCount = counters.blockCount.load(std::memory_order_relaxed);
+    stats.allocationCount = counters.allocationCount.load(std::memory_order_relaxed);
+    return stats;
+}
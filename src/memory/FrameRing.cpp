@@ -0,0 +1,64 @@
+#include <memory/FrameRing.hpp>
+#include <Device.hpp>
+
+#include <cstring>
+#include <algorithm>
+
+const VkDeviceSize FrameRing::DefaultCapacity = 16ull * 1024 * 1024;
+
+FrameRing::FrameRing(const Device &device, VkDeviceSize capacity) : _device(device),
+                                                                    _head(0)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(_device.physical(), &properties);
+
+    _defaultAlignment = std::max<VkDeviceSize>({16,
+                                                properties.limits.minUniformBufferOffsetAlignment,
+                                                properties.limits.minStorageBufferOffsetAlignment});
+
+    _capacity = MemoryBlock::AlignUp(capacity, _defaultAlignment);
+
+    // Stream memory is coherent, so the CPU writes need no explicit flush. It lands in VRAM when the BAR allows it
+    _buffer = _device.allocator().createBuffer(_capacity,
+                                               VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+                                                   VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                               MemoryUsage::Stream);
+}
+
+FrameRing::~FrameRing()
+{
+    _device.allocator().destroyBuffer(_buffer);
+}
+
+void FrameRing::begin()
+{
+    _head = 0;
+}
+
+RingSlice FrameRing::allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+    VkDeviceSize start;
+    {
+        // Only the bump is guarded, the copy into the slice happens outside
+        std::lock_guard lock(_mutex);
+        start = MemoryBlock::AlignUp(_head, alignment == 0 ? _defaultAlignment : alignment);
+        if (start + size > _capacity)
+            throw std::runtime_error("Frame ring is out of space for this frame, raise its capacity!");
+
+        _head = start + size;
+    }
+
+    RingSlice slice;
+    slice.buffer = _buffer.handle;
+    slice.offset = start;
+    slice.size = size;
+    slice.data = static_cast<char *>(_buffer.allocation.mapped) + slice.offset;
+    return slice;
+}
+
+RingSlice FrameRing::push(const void *data, VkDeviceSize size, VkDeviceSize alignment)
+{
+    RingSlice slice = allocate(size, alignment);
+    memcpy(slice.data, data, (size_t)size);
+    return slice;
+}
@@ -0,0 +1,192 @@
+#include <memory/MemoryBlock.hpp>
+
+#include <bit>
+
+MemoryBlock::MemoryBlock(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType, void *mapped) : _memory(memory),
+                                                                                                        _size(size),
+                                                                                                        _used(0),
+                                                                                                        _allocationCount(0),
+                                                                                                        _memoryType(memoryType),
+                                                                                                        _mapped(mapped)
+{
+}
+
+// ------------------------------- LINEAR
+
+LinearBlock::LinearBlock(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType, void *mapped) : MemoryBlock(memory, size, memoryType, mapped),
+                                                                                                        _head(0)
+{
+}
+
+bool LinearBlock::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset)
+{
+    VkDeviceSize start = AlignUp(_head, alignment);
+    if (start + size > _size)
+        return false;
+
+    offset = start;
+    _used += start + size - _head;
+    _head = start + size;
+    _allocationCount++;
+    return true;
+}
+
+void LinearBlock::free(VkDeviceSize offset, VkDeviceSize size)
+{
+    // Nothing is reclaimed until the whole block is empty, then we simply rewind
+    if (--_allocationCount == 0)
+    {
+        _head = 0;
+        _used = 0;
+    }
+}
+
+// ------------------------------- FREE LIST
+
+FreeListBlock::FreeListBlock(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType, void *mapped) : MemoryBlock(memory, size, memoryType, mapped)
+{
+    _freeRanges[0] = size;
+}
+
+bool FreeListBlock::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset)
+{
+    // First fit : the first free range that can hold the aligned request
+    for (auto it = _freeRanges.begin(); it != _freeRanges.end(); ++it)
+    {
+        VkDeviceSize rangeStart = it->first;
+        VkDeviceSize rangeEnd = it->first + it->second;
+        VkDeviceSize start = AlignUp(rangeStart, alignment);
+
+        if (start + size > rangeEnd)
+            continue;
+
+        _freeRanges.erase(it);
+
+        // Keep the alignment padding and the tail as free ranges of their own
+        if (start > rangeStart)
+            _freeRanges[rangeStart] = start - rangeStart;
+        if (start + size < rangeEnd)
+            _freeRanges[start + size] = rangeEnd - (start + size);
+
+        offset = start;
+        _used += size;
+        _allocationCount++;
+        return true;
+    }
+
+    return false;
+}
+
+void FreeListBlock::free(VkDeviceSize offset, VkDeviceSize size)
+{
+    auto it = _freeRanges.emplace(offset, size).first;
+
+    // Merge with the following range
+    auto next = std::next(it);
+    if (next != _freeRanges.end() && it->first + it->second == next->first)
+    {
+        it->second += next->second;
+        _freeRanges.erase(next);
+    }
+
+    // Merge with the previous range
+    if (it != _freeRanges.begin())
+    {
+        auto prev = std::prev(it);
+        if (prev->first + prev->second == it->first)
+        {
+            prev->second += it->second;
+            _freeRanges.erase(it);
+        }
+    }
+
+    _used -= size;
+    _allocationCount--;
+}
+
+// ------------------------------- BUDDY
+
+BuddyBlock::BuddyBlock(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryType, void *mapped) : MemoryBlock(memory, size, memoryType, mapped),
+                                                                                                      _minOrder(8)
+{
+    _maxOrder = static_cast<uint32_t>(std::countr_zero(size));
+    if (_maxOrder < _minOrder)
+        _minOrder = _maxOrder;
+
+    _freeNodes.resize(_maxOrder - _minOrder + 1);
+    _freeNodes.back().insert(0);
+}
+
+VkDeviceSize BuddyBlock::NextPowerOfTwo(VkDeviceSize value)
+{
+    return std::bit_ceil(value);
+}
+
+uint32_t BuddyBlock::orderFor(VkDeviceSize size) const
+{
+    auto order = static_cast<uint32_t>(std::countr_zero(NextPowerOfTwo(size)));
+    return order < _minOrder ? _minOrder : order;
+}
+
+bool BuddyBlock::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset)
+{
+    // Nodes are naturally aligned on their own size, so asking for a node
+    // at least as large as the alignment is enough
+    uint32_t order = orderFor(size > alignment ? size : alignment);
+    if (order > _maxOrder)
+        return false;
+
+    // Find the smallest free node that fits
+    uint32_t found = order;
+    while (found <= _maxOrder && _freeNodes[found - _minOrder].empty())
+        found++;
+
+    if (found > _maxOrder)
+        return false;
+
+    auto &freeList = _freeNodes[found - _minOrder];
+    VkDeviceSize node = *freeList.begin();
+    freeList.erase(freeList.begin());
+
+    // Split it down, giving the upper halves back as free buddies
+    while (found > order)
+    {
+        found--;
+        _freeNodes[found - _minOrder].insert(node + (VkDeviceSize(1) << found));
+    }
+
+    _allocated[node] = order;
+    offset = node;
+    _used += VkDeviceSize(1) << order;
+    _allocationCount++;
+    return true;
+}
+
+void BuddyBlock::free(VkDeviceSize offset, VkDeviceSize size)
+{
+    auto it = _allocated.find(offset);
+    if (it == _allocated.end())
+        throw std::runtime_error("Freeing an unknown buddy allocation!");
+
+    uint32_t order = it->second;
+    _allocated.erase(it);
+    _used -= VkDeviceSize(1) << order;
+    _allocationCount--;
+
+    // Merge with the buddy as long as it is free too
+    VkDeviceSize node = offset;
+    while (order < _maxOrder)
+    {
+        VkDeviceSize buddy = node ^ (VkDeviceSize(1) << order);
+        auto &freeList = _freeNodes[order - _minOrder];
+        auto buddyIt = freeList.find(buddy);
+        if (buddyIt == freeList.end())
+            break;
+
+        freeList.erase(buddyIt);
+        node = node < buddy ? node : buddy;
+        order++;
+    }
+
+    _freeNodes[order - _minOrder].insert(node);
+}
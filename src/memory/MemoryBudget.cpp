@@ -0,0 +1,62 @@
+#include <memory/MemoryBudget.hpp>
+#include <memory/Allocator.hpp>
+#include <Device.hpp>
+
+#include <algorithm>
+#include <limits>
+
+const float MemoryBudget::FallbackBudgetRatio = 0.8f;
+
+MemoryBudget::MemoryBudget(const Device &device, bool extensionEnabled) : _device(device),
+                                                                          _fromDriver(extensionEnabled)
+{
+    const VkPhysicalDeviceMemoryProperties &properties = _device.allocator().memoryProperties();
+
+    _heaps.resize(properties.memoryHeapCount);
+    for (uint32_t i = 0; i < properties.memoryHeapCount; i++)
+    {
+        _heaps[i].size = properties.memoryHeaps[i].size;
+        _heaps[i].deviceLocal = properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+    }
+
+    update();
+}
+
+void MemoryBudget::update()
+{
+    if (_fromDriver)
+    {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+        budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        VkPhysicalDeviceMemoryProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        properties.pNext = &budget;
+
+        vkGetPhysicalDeviceMemoryProperties2(_device.physical(), &properties);
+
+        for (uint32_t i = 0; i < heapCount(); i++)
+        {
+            _heaps[i].budget = budget.heapBudget[i];
+            _heaps[i].usage = budget.heapUsage[i];
+        }
+        return;
+    }
+
+    // Without the extension we only know about our own blocks, and have to guess the budget
+    for (uint32_t i = 0; i < heapCount(); i++)
+    {
+        _heaps[i].budget = static_cast<VkDeviceSize>(_heaps[i].size * FallbackBudgetRatio);
+        _heaps[i].usage = _device.allocator().heapStats(i).blockBytes;
+    }
+}
+
+VkDeviceSize MemoryBudget::deviceLocalHeadroom() const
+{
+    VkDeviceSize headroom = std::numeric_limits<VkDeviceSize>::max();
+    for (const HeapBudget &heap : _heaps)
+        if (heap.deviceLocal)
+            headroom = std::min(headroom, heap.headroom());
+
+    return headroom;
+}
@@ -0,0 +1,78 @@
+#include <memory/MemoryTypes.hpp>
+
+#include <algorithm>
+#include <bit>
+
+const VkDeviceSize MemoryTypeTable::BarWindowSize = 256ull * 1024 * 1024;
+
+MemoryTypeTable::MemoryTypeTable(const VkPhysicalDevice &physical) : _unifiedMemory(false),
+                                                                     _resizableBar(false)
+{
+    vkGetPhysicalDeviceMemoryProperties(physical, &_properties);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physical, &properties);
+    _nonCoherentAtomSize = properties.limits.nonCoherentAtomSize;
+
+    // Integrated GPUs may still split their memory in several heaps, but all of them are device local
+    bool allDeviceLocal = true;
+    for (uint32_t i = 0; i < _properties.memoryHeapCount; i++)
+        allDeviceLocal &= (_properties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    _unifiedMemory = properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU || allDeviceLocal;
+
+    // Without resizable BAR, the mappable part of VRAM is a small window
+    const VkMemoryPropertyFlags barFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    for (uint32_t i = 0; i < _properties.memoryTypeCount && !_unifiedMemory; i++)
+        if ((flags(i) & barFlags) == barFlags && _properties.memoryHeaps[heapIndex(i)].size > BarWindowSize)
+            _resizableBar = true;
+
+    buildPreferred(MemoryUsage::GpuOnly, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0,
+                   _unifiedMemory ? 0 : VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    // Keep the BAR for streamed data, staging is fine in system memory
+    buildPreferred(MemoryUsage::Upload, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                   _unifiedMemory ? VK_MEMORY_PROPERTY_HOST_CACHED_BIT : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    buildPreferred(MemoryUsage::Readback, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0);
+    // Coherent is required : streamed data is written all over the frame, flushing every write isn't worth it.
+    // HOST_VISIBLE | HOST_COHERENT is guaranteed to exist, so this never comes out empty
+    buildPreferred(MemoryUsage::Stream, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                   VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+}
+
+void MemoryTypeTable::buildPreferred(MemoryUsage usage, VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, VkMemoryPropertyFlags avoided)
+{
+    auto &candidates = _preferred[static_cast<size_t>(usage)];
+    std::vector<int> scores(_properties.memoryTypeCount, 0);
+
+    // Every preferred flag present scores, every avoided flag present costs; ties keep the driver's order
+    for (uint32_t i = 0; i < _properties.memoryTypeCount; i++)
+    {
+        if ((flags(i) & required) != required || (flags(i) & (VK_MEMORY_PROPERTY_PROTECTED_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)))
+            continue;
+
+        scores[i] = std::popcount(flags(i) & preferred) - std::popcount(flags(i) & avoided);
+        candidates.push_back(i);
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(), [&](uint32_t a, uint32_t b)
+                     { return scores[a] > scores[b]; });
+}
+
+uint32_t MemoryTypeTable::find(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < _properties.memoryTypeCount; i++)
+    {
+        if ((typeFilter & (1 << i)) && (flags(i) & properties) == properties)
+            return i;
+    }
+
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+uint32_t MemoryTypeTable::find(uint32_t typeFilter, MemoryUsage usage) const
+{
+    for (uint32_t memoryType : _preferred[static_cast<size_t>(usage)])
+        if (typeFilter & (1 << memoryType))
+            return memoryType;
+
+    throw std::runtime_error("failed to find a memory type for this usage!");
+}
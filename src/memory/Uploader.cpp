@@ -0,0 +1,273 @@
+#include <memory/Uploader.hpp>
+#include <Device.hpp>
+#include <Scheduler.hpp>
+
+#include <cstring>
+#include <algorithm>
+
+const VkDeviceSize Uploader::DefaultCapacity = 32ull * 1024 * 1024;
+const uint32_t Uploader::BatchCount = 4;
+
+// Staging offsets are kept 16 bytes aligned, good enough for every copy we do
+static const VkDeviceSize StagingAlignment = 16;
+
+Uploader::Uploader(const Device &device, VkDeviceSize capacity) : _device(device),
+                                                                  _submitted(0),
+                                                                  _retired(0),
+                                                                  _recording(false),
+                                                                  _flushed(0),
+                                                                  _capacity(capacity),
+                                                                  _head(0),
+                                                                  _tail(0),
+                                                                  _queuedStages(0),
+                                                                  _readyStages(0)
+{
+    _staging = _device.allocator().createBuffer(_capacity, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MemoryUsage::Upload);
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = _device.transferFamily();
+
+    if (vkCreateCommandPool(_device.logical(), &poolInfo, nullptr, &_pool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create upload command pool!");
+
+    _batches.resize(BatchCount);
+
+    std::vector<VkCommandBuffer> commands(BatchCount);
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.commandPool = _pool;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandBufferCount = BatchCount;
+
+    if (vkAllocateCommandBuffers(_device.logical(), &allocInfo, commands.data()) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate upload command buffers!");
+
+    for (uint32_t i = 0; i < BatchCount; i++)
+        _batches[i].command = commands[i];
+}
+
+Uploader::~Uploader()
+{
+    waitIdle();
+
+    vkDestroyCommandPool(_device.logical(), _pool, nullptr);
+
+    _device.allocator().destroyBuffer(_staging);
+}
+
+void Uploader::begin()
+{
+    // All batches in flight : the oldest one has to finish before its slot can be reused
+    if (_submitted - _retired >= BatchCount)
+        retire(true);
+
+    auto &batch = _batches[_submitted % BatchCount];
+    vkResetCommandBuffer(batch.command, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(batch.command, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("failed to begin recording upload command buffer!");
+
+    _recording = true;
+}
+
+void Uploader::submit()
+{
+    auto &batch = _batches[_submitted % BatchCount];
+
+    // Hand the written ranges over to the graphics family
+    if (!_releases.empty())
+    {
+        vkCmdPipelineBarrier(batch.command, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                             0, nullptr,
+                             static_cast<uint32_t>(_releases.size()), _releases.data(),
+                             0, nullptr);
+        _releases.clear();
+    }
+
+    if (vkEndCommandBuffer(batch.command) != VK_SUCCESS)
+        throw std::runtime_error("failed to record upload command buffer!");
+
+    // Every batch signals the transfer timeline : reaching a value also covers all the batches before it
+    batch.value = _device.scheduler().submit(QueueType::Transfer, {&batch.command, 1});
+
+    batch.stagingEnd = _head;
+    _submitted++;
+    _recording = false;
+}
+
+void Uploader::retire(bool waitOldest)
+{
+    while (_retired < _submitted)
+    {
+        auto &batch = _batches[_retired % BatchCount];
+
+        if (waitOldest)
+        {
+            _device.scheduler().timeline(QueueType::Transfer).wait(batch.value);
+            waitOldest = false;
+        }
+        else if (!_device.scheduler().reached(QueueType::Transfer, batch.value))
+            break;
+
+        _tail = batch.stagingEnd;
+        _retired++;
+    }
+
+    // Ring fully drained and nothing pending, start over from the beginning
+    if (_retired == _submitted && !_recording && _tail == _head)
+        _head = _tail = 0;
+}
+
+VkDeviceSize Uploader::reserve(VkDeviceSize size)
+{
+    while (true)
+    {
+        VkDeviceSize start = MemoryBlock::AlignUp(_head, StagingAlignment);
+
+        // A range never straddles the end of the ring, skip to the next lap instead
+        if (start % _capacity + size > _capacity)
+            start = (start / _capacity + 1) * _capacity;
+
+        if (start + size - _tail <= _capacity)
+        {
+            _head = start + size;
+            return start % _capacity;
+        }
+
+        // Ring is full : push what was recorded and wait for the oldest batch to give space back
+        if (_recording)
+            submit();
+        retire(true);
+    }
+}
+
+Buffer Uploader::createBuffer(const void *data, VkDeviceSize size, VkBufferUsageFlags usage, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+{
+    // UMA and resizable BAR : the CPU can write straight into device local memory
+    if (_device.memoryTypes().directUpload())
+    {
+        Buffer buffer = _device.allocator().createBuffer(size, usage, MemoryUsage::Stream);
+        enqueue(data, size, buffer, 0, dstStage, dstAccess);
+        return buffer;
+    }
+
+    Buffer buffer = _device.allocator().createBuffer(size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, MemoryUsage::GpuOnly);
+    enqueue(data, size, buffer, 0, dstStage, dstAccess);
+    return buffer;
+}
+
+void Uploader::enqueue(const void *data, VkDeviceSize size, const Buffer &dst, VkDeviceSize dstOffset, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+{
+    // Mapped destination : no copy to record. Host writes are visible to every later queue submission
+    if (dst.allocation.mapped != nullptr)
+    {
+        memcpy(static_cast<char *>(dst.allocation.mapped) + dstOffset, data, (size_t)size);
+        _device.allocator().flush(dst.allocation, dstOffset, size);
+        return;
+    }
+
+    const char *src = static_cast<const char *>(data);
+    bool crossFamily = _device.hasDedicatedTransfer();
+
+    // Data bigger than the ring goes through in several chunks
+    VkDeviceSize done = 0;
+    while (done < size)
+    {
+        VkDeviceSize chunk = std::min(size - done, _capacity);
+        VkDeviceSize stagingOffset = reserve(chunk);
+
+        if (!_recording)
+            begin();
+
+        memcpy(static_cast<char *>(_staging.allocation.mapped) + stagingOffset, src + done, (size_t)chunk);
+        _device.allocator().flush(_staging.allocation, stagingOffset, chunk);
+
+        VkBufferCopy region{};
+        region.srcOffset = stagingOffset;
+        region.dstOffset = dstOffset + done;
+        region.size = chunk;
+        vkCmdCopyBuffer(_batches[_submitted % BatchCount].command, _staging.handle, dst.handle, 1, &region);
+
+        if (crossFamily)
+        {
+            VkBufferMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+            barrier.srcQueueFamilyIndex = _device.transferFamily();
+            barrier.dstQueueFamilyIndex = _device.queueFamilyIndices().graphicsFamily.value();
+            barrier.buffer = dst.handle;
+            barrier.offset = region.dstOffset;
+            barrier.size = region.size;
+
+            // Release side only has to make the copy available
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = 0;
+            _releases.push_back(barrier);
+
+            // Acquire side only has to make it visible to the consumers
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = dstAccess;
+            _queuedAcquires.push_back(barrier);
+        }
+
+        done += chunk;
+    }
+
+    _queuedStages |= dstStage;
+}
+
+UploadSync Uploader::flush()
+{
+    UploadSync sync;
+
+    retire(false);
+
+    if (_recording)
+        submit();
+
+    // Nothing went out since the last flush, including batches pushed early because the ring was full
+    uint64_t latest = _device.scheduler().timeline(QueueType::Transfer).pending();
+    if (latest == _flushed)
+        return sync;
+
+    sync.value = latest;
+    sync.stages = _queuedStages;
+    _flushed = latest;
+
+    _readyAcquires.insert(_readyAcquires.end(), _queuedAcquires.begin(), _queuedAcquires.end());
+    _queuedAcquires.clear();
+    _readyStages |= _queuedStages;
+    _queuedStages = 0;
+
+    return sync;
+}
+
+void Uploader::recordAcquireBarriers(const VkCommandBuffer &commandBuffer)
+{
+    if (_readyAcquires.empty())
+        return;
+
+    // Source stage matches the semaphore wait stage so the barrier chains after it
+    VkPipelineStageFlags stages = _readyStages;
+
+    vkCmdPipelineBarrier(commandBuffer, stages, stages, 0,
+                         0, nullptr,
+                         static_cast<uint32_t>(_readyAcquires.size()), _readyAcquires.data(),
+                         0, nullptr);
+    _readyAcquires.clear();
+    _readyStages = 0;
+}
+
+void Uploader::waitIdle()
+{
+    if (_recording)
+        submit();
+
+    _device.scheduler().timeline(QueueType::Transfer).wait(_device.scheduler().timeline(QueueType::Transfer).pending());
+    retire(false);
+}
@@ -1,5 +1,11 @@
 #include <ui/UI.hpp>
-#include <ui/UIRenderPass.hpp>
+
+#include <memory/MemoryBudget.hpp>
+#include <FrameContext.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 
 void UI::createImGuiDescriptorPool()
 {
@@ -29,19 +35,23 @@ void UI::createImGuiDescriptorPool()
         throw std::runtime_error("Cannot allocate UI descriptor pool!");
 }
 
-void UI::recreate()
-{
-    _renderPass.recreate();
-    _commandPool.recreateCommandBuffers();
-    _renderPass.cleanupOld();
-};
-
-UI::UI(const Window &window, const Device &device, const SwapChain &swapChain, const GraphicsPipeline &graphicsPipeline) : _window(window),
-                                                                                                                           _device(device),
-                                                                                                                           _swapChain(swapChain),
-                                                                                                                           _graphicsPipeline(graphicsPipeline),
-                                                                                                                           _renderPass(_device, _swapChain),
-                                                                                                                           _commandPool(_device, _renderPass, _swapChain, _graphicsPipeline, 0)
+UI::UI(const Window &window, const Device &device, const SwapChain &swapChain, const DefaultRenderPass &renderPass, const GraphicsPipeline &graphicsPipeline, const GpuProfiler &gpuProfiler,
+       const PipelineStatistics &pipelineStatistics, uint32_t framesInFlight) : _window(window),
+                                                                                _device(device),
+                                                                                _swapChain(swapChain),
+                                                                                _graphicsPipeline(graphicsPipeline),
+                                                                                _gpuProfiler(gpuProfiler),
+                                                                                _pipelineStatistics(pipelineStatistics),
+                                                                                _renderPass(renderPass),
+                                                                                _renderer(_device, _renderPass, _swapChain, _graphicsPipeline),
+                                                                                _presentModes(swapChain.supportDetails().presentModes),
+                                                                                _lastFrame(std::chrono::steady_clock::now()),
+                                                                                framesInFlight(static_cast<int>(framesInFlight)),
+                                                                                presentMode(swapChain.presentMode()),
+                                                                                fpsCap(0),
+                                                                                maxQueuedFrames(1),
+                                                                                pipelineStatistics(false),
+                                                                                traceRequested(false)
 {
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
@@ -56,8 +66,9 @@ UI::UI(const Window &window, const Device &device, const SwapChain &swapChain, c
 
     QueueFamily indices = QueueFamily(_device.physical(), _window.surface());
 
-    // Setup Platform/Renderer bindings
-    ImGui_ImplGlfw_InitForVulkan((GLFWwindow *)_window.window(), true);
+    // Setup Platform/Renderer bindings. Headless, there is no platform : draw() feeds ImGui the display size and time itself
+    if (!_window.headless())
+        ImGui_ImplGlfw_InitForVulkan((GLFWwindow *)_window.window(), true);
     ImGui_ImplVulkan_InitInfo init_info = {};
     init_info.Instance = _window.instance();
     init_info.PhysicalDevice = _device.physical();
@@ -65,26 +76,58 @@ UI::UI(const Window &window, const Device &device, const SwapChain &swapChain, c
     init_info.QueueFamily = indices.graphicsFamily.value();
     init_info.Queue = _device.graphicsQueue();
     init_info.DescriptorPool = _imGuiDescriptorPool;
-    init_info.MinImageCount = _swapChain.numImages();
-    init_info.ImageCount = _swapChain.numImages();
-    init_info.RenderPass = _renderPass.handle();
+    // The backend streams the UI geometry through a ring of ImageCount buffers, one step per frame : the ring has to
+    // outlast the frames in flight, whatever the number of swapchain images
+    init_info.MinImageCount = std::max<uint32_t>(static_cast<uint32_t>(_swapChain.numImages()), 2);
+    init_info.ImageCount = std::max(init_info.MinImageCount, FrameContext::MaxFramesInFlight);
+    init_info.ApiVersion = Window::ApiVersion;
+
+    // Drawn after the scene, in the same render pass
+    VkFormat colorFormat = _renderPass.colorFormat();
+    if (_renderPass.dynamic())
+    {
+        init_info.UseDynamicRendering = true;
+        init_info.PipelineRenderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+        init_info.PipelineRenderingCreateInfo.colorAttachmentCount = 1;
+        // Copied by the backend
+        init_info.PipelineRenderingCreateInfo.pColorAttachmentFormats = &colorFormat;
+    }
+    else
+    {
+        init_info.RenderPass = _renderPass.handle();
+        init_info.Subpass = DefaultRenderPass::OverlaySubpass;
+    }
     ImGui_ImplVulkan_Init(&init_info);
+
+    // Otherwise the first NewFrame() uploads it, submitting to the graphics queue from the main thread
+    // while the render thread may be using it
+    ImGui_ImplVulkan_CreateFontsTexture();
 }
 
 UI::~UI()
 {
     // Resources to destroy when the program ends
     ImGui_ImplVulkan_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
+    if (!_window.headless())
+        ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
     vkDestroyDescriptorPool(_device.logical(), _imGuiDescriptorPool, nullptr);
 }
 
+void UI::swapChainRecreated()
+{
+    // Waits for the device, only when the count actually changed
+    ImGui_ImplVulkan_SetMinImageCount(std::max<uint32_t>(static_cast<uint32_t>(_swapChain.numImages()), 2));
+}
+
 void UI::draw()
 {
     // Start the Dear ImGui frame
     ImGui_ImplVulkan_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
+    if (_window.headless())
+        newHeadlessFrame();
+    else
+        ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 
     static float f = 0.0f;
@@ -101,7 +144,170 @@ void UI::draw()
     ImGui::Text("counter = %d", counter);
 
     ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+    // More frames in flight : more CPU/GPU overlap, but also more latency
+    ImGui::SliderInt("Frames in flight", &framesInFlight, 1, static_cast<int>(FrameContext::MaxFramesInFlight));
+
+    // Lowest latency (immediate, limiter on) or lowest power draw (FIFO, FPS cap)
+    if (ImGui::BeginCombo("Present mode", SwapChain::PresentModeName(presentMode)))
+    {
+        for (VkPresentModeKHR mode : _presentModes)
+            if (ImGui::Selectable(SwapChain::PresentModeName(mode), mode == presentMode))
+                presentMode = mode;
+        ImGui::EndCombo();
+    }
+    ImGui::SliderInt("FPS cap (0 : none)", &fpsCap, 0, 240);
+    if (_device.presentWaitEnabled())
+        ImGui::SliderInt("Queued presents (0 : no limit)", &maxQueuedFrames, 0, 3);
+    else
+        ImGui::TextDisabled("Latency limiter unavailable : no VK_KHR_present_wait");
+
+    // CPU zones of the last frames, for chrome://tracing or ui.perfetto.dev
+    if (ImGui::Button("Write CPU trace (F12)") || ImGui::IsKeyPressed(ImGuiKey_F12, false))
+        traceRequested = true;
     ImGui::End();
 
+    drawMemoryPanel();
+    drawGpuPanel();
+    drawStatisticsPanel();
+
     ImGui::Render();
+}
+
+void UI::newHeadlessFrame()
+{
+    ImGuiIO &io = ImGui::GetIO();
+
+    glm::ivec2 size;
+    _window.framebufferSize(size);
+    io.DisplaySize = ImVec2(static_cast<float>(size.x), static_cast<float>(size.y));
+
+    // ImGui asserts on a zero delta time
+    auto now = std::chrono::steady_clock::now();
+    float deltaTime = std::chrono::duration<float>(now - _lastFrame).count();
+    io.DeltaTime = deltaTime > 0.0f ? deltaTime : 1.0f / 60.0f;
+    _lastFrame = now;
+}
+
+void UI::drawMemoryPanel()
+{
+    const MemoryBudget &budget = _device.budget();
+    const float MiB = 1024.0f * 1024.0f;
+
+    ImGui::Begin("Memory");
+    ImGui::Text("Source : %s", budget.fromDriver() ? "VK_EXT_memory_budget" : "internal accounting (estimate)");
+
+    for (uint32_t i = 0; i < budget.heapCount(); i++)
+    {
+        const HeapBudget &heap = budget.heap(i);
+
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "%.0f / %.0f MiB", heap.usage / MiB, heap.budget / MiB);
+
+        ImGui::Text("Heap %u (%s, %.0f MiB)", i, heap.deviceLocal ? "device local" : "host", heap.size / MiB);
+        ImGui::ProgressBar(heap.ratio(), ImVec2(-1.0f, 0.0f), overlay);
+    }
+
+    ImGui::End();
+}
+
+void UI::drawGpuPanel()
+{
+    ImGui::Begin("GPU");
+
+    if (!_gpuProfiler.enabled())
+    {
+        ImGui::TextDisabled("No timestamps on the graphics queue");
+        ImGui::End();
+        return;
+    }
+
+    std::vector<GpuFrameResult> history = _gpuProfiler.history();
+    if (history.empty())
+    {
+        ImGui::End();
+        return;
+    }
+
+    // A few frames behind : the queries are read once the GPU is done with them
+    const GpuFrameResult &last = history.back();
+    ImGui::Text("Frame %llu", static_cast<unsigned long long>(last.frameNumber));
+
+    std::vector<float> values;
+    values.reserve(history.size());
+    for (size_t scope = 0; scope < last.scopes.size(); scope++)
+    {
+        const GpuScopeResult &result = last.scopes[scope];
+
+        // Scope i of a frame is the same pass from one frame to the next, as long as the frame records the same passes
+        values.clear();
+        float peak = 0.0f;
+        for (const GpuFrameResult &frame : history)
+            if (scope < frame.scopes.size() && frame.scopes[scope].name == result.name)
+            {
+                values.push_back(static_cast<float>(frame.scopes[scope].ms));
+                peak = std::max(peak, values.back());
+            }
+
+        // Indent(0) would indent by the default spacing
+        float indent = static_cast<float>(result.depth) * ImGui::GetStyle().IndentSpacing;
+        if (indent > 0.0f)
+            ImGui::Indent(indent);
+        ImGui::Text("%-8s %7.3f ms", result.name, result.ms);
+
+        char label[64];
+        snprintf(label, sizeof(label), "##%s%zu", result.name, scope);
+        ImGui::PlotLines(label, values.data(), static_cast<int>(values.size()), 0, nullptr, 0.0f, peak * 1.2f, ImVec2(-1.0f, 40.0f));
+        if (indent > 0.0f)
+            ImGui::Unindent(indent);
+    }
+
+    ImGui::End();
+}
+
+void UI::drawStatisticsPanel()
+{
+    ImGui::Begin("Pipeline statistics");
+
+    if (!_pipelineStatistics.supported())
+    {
+        ImGui::TextDisabled("Unavailable : no pipelineStatisticsQuery");
+        ImGui::End();
+        return;
+    }
+
+    // Off by default : the cached command buffers are recorded again every frame meanwhile
+    ImGui::Checkbox("Count (records every frame)", &pipelineStatistics);
+
+    std::vector<FrameStatistics> history = _pipelineStatistics.history();
+    if (!pipelineStatistics || history.empty())
+    {
+        ImGui::End();
+        return;
+    }
+
+    const FrameStatistics &last = history.back();
+    ImGui::Text("Frame %llu", static_cast<unsigned long long>(last.frameNumber));
+
+    glm::ivec2 size;
+    _window.framebufferSize(size);
+    double pixels = std::max(static_cast<double>(size.x) * static_cast<double>(size.y), 1.0);
+
+    for (const PassStatistics &pass : last.passes)
+    {
+        ImGui::SeparatorText(pass.name);
+        ImGui::Text("Input vertices         %12llu", static_cast<unsigned long long>(pass.inputVertices));
+        ImGui::Text("Vertex invocations     %12llu", static_cast<unsigned long long>(pass.vertexInvocations));
+        ImGui::Text("Clipping in / out      %12llu / %llu", static_cast<unsigned long long>(pass.clippingInvocations),
+                    static_cast<unsigned long long>(pass.clippingPrimitives));
+        ImGui::Text("Fragment invocations   %12llu", static_cast<unsigned long long>(pass.fragmentInvocations));
+
+        // Vertex reuse, primitives culled or clipped away before rasterization, and fragments shaded per pixel
+        if (pass.inputVertices != 0)
+            ImGui::Text("Vertex cache hits      %11.1f %%", 100.0 * (1.0 - static_cast<double>(pass.vertexInvocations) / static_cast<double>(pass.inputVertices)));
+        if (pass.clippingInvocations != 0)
+            ImGui::Text("Culled or clipped      %11.1f %%", 100.0 * (1.0 - static_cast<double>(pass.clippingPrimitives) / static_cast<double>(pass.clippingInvocations)));
+        ImGui::Text("Overdraw               %11.2f x", static_cast<double>(pass.fragmentInvocations) / pixels);
+    }
+
+    ImGui::End();
 }
\ No newline at end of file
@@ -0,0 +1,25 @@
+#include <ui/UIDrawData.hpp>
+
+UIDrawData::~UIDrawData()
+{
+    clear();
+}
+
+void UIDrawData::capture(const ImDrawData *source)
+{
+    clear();
+    if (!source || !source->Valid)
+        return;
+
+    // The header is copied as is, then the lists are swapped for deep copies of their buffers
+    _drawData = *source;
+    for (ImDrawList *&list : _drawData.CmdLists)
+        list = list->CloneOutput();
+}
+
+void UIDrawData::clear()
+{
+    for (ImDrawList *list : _drawData.CmdLists)
+        IM_DELETE(list);
+    _drawData.Clear();
+}
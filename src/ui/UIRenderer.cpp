@@ -0,0 +1,21 @@
+#include <imgui.h>
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_vulkan.h>
+
+#include <ui/UIRenderer.hpp>
+
+#include <RenderPass.hpp>
+#include <Device.hpp>
+#include <SwapChain.hpp>
+#include <GraphicsPipeline.hpp>
+
+UIRenderer::UIRenderer(const Device &device, const RenderPass &renderPass, const SwapChain &swapChain, const GraphicsPipeline &graphicsPipeline) : Renderer(device, renderPass, swapChain, graphicsPipeline),
+                                                                                                                                                    _drawData(nullptr)
+{
+}
+
+void UIRenderer::record(VkCommandBuffer commandBuffer, FrameContext &frame, const DrawState &state)
+{
+    // Grab and record the draw data for Dear Imgui
+    ImGui_ImplVulkan_RenderDrawData(_drawData ? _drawData : ImGui::GetDrawData(), commandBuffer);
+}